@@ -0,0 +1,186 @@
+// Parse and serialize throughput of json.hpp.
+//
+//   make bench CORPUS="twitter.json canada.json citm_catalog.json"
+//
+// Each file named on the command line is measured along with synthetic
+// deep-nesting and wide-array cases. Throughput is in MB/s of json text,
+// allocations are counted per document through operator new.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "json.hpp"
+
+static std::atomic<std::size_t> allocations{ 0 };
+
+void *operator new(std::size_t size)
+{
+    ++allocations;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+struct result
+{
+    double mbps;
+    double allocs;
+};
+
+// Best throughput over repeated runs of f, for a document of bytes bytes
+static result measure(std::size_t bytes, std::function<void()> const &f)
+{
+    using clock = std::chrono::steady_clock;
+    double best = 1e300;
+    std::size_t runs = 0, allocs = 0;
+    auto start = clock::now();
+    do
+    {
+        auto before = allocations.load();
+        auto t0 = clock::now();
+        f();
+        auto t1 = clock::now();
+        allocs += allocations.load() - before;
+        best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+        ++runs;
+    } while (runs < 3 || (clock::now() - start < std::chrono::milliseconds(500) && runs < 1000));
+    return result{ bytes / best / 1e6, double(allocs) / runs };
+}
+
+struct bench_case
+{
+    std::string name;
+    std::string text;
+    // Conversion through json::get<T>, if the case has a natural T
+    std::function<void(json::value const &)> get;
+};
+
+static void run(bench_case const &c)
+{
+    json::value v = json::parse(c.text);
+    std::string out = v.json();
+
+    auto parse = measure(c.text.size(), [&] { json::parse(c.text); });
+    auto stream = measure(c.text.size(), [&] {
+        std::istringstream in(c.text);
+        json::parse(in);
+    });
+    auto write = measure(out.size(), [&] { v.json(); });
+
+    std::printf("%-22s %9.2f %10.1f %11.0f %10.1f %10.1f %11.0f", c.name.c_str(), c.text.size() / 1e6, parse.mbps, parse.allocs,
+                stream.mbps, write.mbps, write.allocs);
+    if (c.get)
+    {
+        auto get = measure(c.text.size(), [&] { c.get(v); });
+        std::printf(" %10.1f", get.mbps);
+    }
+    std::printf("\n");
+}
+
+static bench_case deep(int depth)
+{
+    std::string s(depth, '[');
+    s += "1";
+    s.append(depth, ']');
+    return bench_case{ "deep " + std::to_string(depth), s, nullptr };
+}
+
+static bench_case wide_numbers(int n)
+{
+    std::string s = "[";
+    for (int i = 0; i < n; ++i)
+    {
+        if (i)
+            s += ", ";
+        s += std::to_string(i * 0.37 - 1000);
+    }
+    s += "]";
+    return bench_case{ "wide numbers " + std::to_string(n), s, [](json::value const &v) { json::get<std::vector<double>>(v); } };
+}
+
+static bench_case wide_integers(int n)
+{
+    std::string s = "[";
+    for (int i = 0; i < n; ++i)
+    {
+        if (i)
+            s += ", ";
+        s += std::to_string(i * 7919LL);
+    }
+    s += "]";
+    return bench_case{ "wide integers " + std::to_string(n), s, [](json::value const &v) { json::get<std::vector<std::int64_t>>(v); } };
+}
+
+static bench_case wide_strings(int n)
+{
+    std::string s = "[";
+    for (int i = 0; i < n; ++i)
+    {
+        if (i)
+            s += ", ";
+        s += "\"item " + std::to_string(i) + " with some \\\"quoted\\\" text\"";
+    }
+    s += "]";
+    return bench_case{ "wide strings " + std::to_string(n), s, [](json::value const &v) { json::get<std::vector<std::string>>(v); } };
+}
+
+static bench_case wide_object(int n)
+{
+    std::string s = "{";
+    for (int i = 0; i < n; ++i)
+    {
+        if (i)
+            s += ", ";
+        s += "\"key" + std::to_string(i) + "\": " + std::to_string(i);
+    }
+    s += "}";
+    return bench_case{ "wide object " + std::to_string(n), s,
+                       [](json::value const &v) { json::get<std::unordered_map<std::string, int>>(v); } };
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<bench_case> cases;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::ifstream in(argv[i], std::ios::binary);
+        if (!in)
+        {
+            std::cerr << "cannot read " << argv[i] << "\n";
+            return 1;
+        }
+        std::ostringstream text;
+        text << in.rdbuf();
+        std::string name = argv[i];
+        cases.push_back(bench_case{ name.substr(name.find_last_of('/') + 1), text.str(), nullptr });
+    }
+    cases.push_back(deep(1000));
+    cases.push_back(wide_numbers(1000000));
+    cases.push_back(wide_integers(1000000));
+    cases.push_back(wide_strings(200000));
+    cases.push_back(wide_object(200000));
+
+    std::printf("%-22s %9s %10s %11s %10s %10s %11s %10s\n", "case", "MB", "parse", "allocs/doc", "istream", "json()", "allocs/doc",
+                "get<T>");
+    for (auto const &c : cases)
+        run(c);
+}
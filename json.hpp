@@ -36,20 +36,90 @@ freely, subject to the following restrictions:
  *
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <fstream>
+#include <functional>
 #include <iostream>
 #include <iterator>
+#include <limits>
+#include <locale>
 #include <map>
-#include <memory>
+#include <new>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#ifndef JSON_HAS_MMAP
+#if defined(__unix__) || defined(__APPLE__)
+#define JSON_HAS_MMAP 1
+#else
+#define JSON_HAS_MMAP 0
+#endif
+#endif
+
+#ifndef JSON_INSTRUMENT
+#define JSON_INSTRUMENT 0
+#endif
+
+#ifndef JSON_MAX_DEPTH
+#define JSON_MAX_DEPTH 1024
+#endif
+
+#ifndef JSON_MAX_INTERNED_KEYS
+#define JSON_MAX_INTERNED_KEYS 65536
+#endif
+
+// JSON_ORDERED_OBJECT and JSON_SINGLE_THREADED change what an object and a
+// shared box are. Everything is declared in an inline namespace named after
+// them, so translation units built with different settings fail to link
+// rather than share mismatched definitions.
+#if defined(JSON_ORDERED_OBJECT) && defined(JSON_SINGLE_THREADED)
+#define JSON_CONFIG_NAMESPACE cfg_ordered_st
+#elif defined(JSON_ORDERED_OBJECT)
+#define JSON_CONFIG_NAMESPACE cfg_ordered_mt
+#elif defined(JSON_SINGLE_THREADED)
+#define JSON_CONFIG_NAMESPACE cfg_unordered_st
+#else
+#define JSON_CONFIG_NAMESPACE cfg_unordered_mt
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if JSON_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 /**
  * @brief contains classes and functions for handling json
  **/
 namespace json
 {
+inline namespace JSON_CONFIG_NAMESPACE
+{
 
 class value;
 
@@ -59,177 +129,336 @@ class value;
 using string = std::string;
 
 /**
- * @brief The json object is really a std::unordered_map<string, @ref value>
+ * @brief A non-owning reference to a run of characters
  **/
-using object = std::unordered_map<string, value>;
+class string_ref
+{
+private:
+    const char *_data{ nullptr };
+    std::size_t _size{ 0 };
 
-/**
- * @brief The array is really a std::vector<@ref value>
- **/
-using array = std::vector<value>;
+public:
+    string_ref() {}
 
-/**
- * @brief The number is really a double
- * @warning This will probably change soon
- **/
-using number = double;
+    /**
+     * @brief refer to size characters starting at data
+     **/
+    string_ref(const char *data, std::size_t size)
+        : _data(data)
+        , _size(size)
+    {
+    }
 
-std::ostream &operator<<(std::ostream &, object const &);
-std::ostream &operator<<(std::ostream &, array const &);
+    /**
+     * @brief refer to the contents of a string
+     **/
+    string_ref(string const &s)
+        : _data(s.data())
+        , _size(s.size())
+    {
+    }
 
-/**
- * @brief Create an escaped string from an unescaped string.
- * @param value an unescaped string
- * @return an escaped string
- **/
-inline string escape(string const &value)
-{
-    std::stringstream ss;
-    for (auto &c : value)
+    /**
+     * @brief refer to a null-terminated C-string
+     **/
+    string_ref(const char *s)
+        : _data(s)
+        , _size(std::strlen(s))
     {
-        if (c == '"' // TODO: other escapes
-            || c == '\\')
-            ss << '\\';
-        ss << c;
     }
-    return ss.str();
+
+    const char *data() const { return _data; }
+    std::size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    const char *begin() const { return _data; }
+    const char *end() const { return _data + _size; }
+    char operator[](std::size_t i) const { return _data[i]; }
+
+    /**
+     * @return a copy of the referenced characters
+     **/
+    string str() const { return string(_data, _size); }
+    explicit operator string() const { return str(); }
+};
+
+inline bool operator==(string_ref const &a, string_ref const &b)
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size()) == 0;
 }
 
-/**
- * @brief Create an unescaped string from an escaped string.
- * @param value an escaped string
- * @return an unescaped string
- **/
-inline string unescape(string const &value)
+inline bool operator!=(string_ref const &a, string_ref const &b)
 {
-    std::stringstream ss;
-    for (const char *c = value.data(); *c != '\0'; ++c)
-    {
-        if (*c == '\\')
-            ++c;
-        ss << *c;
-    }
-    return ss.str();
+    return !(a == b);
+}
+
+inline std::ostream &operator<<(std::ostream &o, string_ref const &s)
+{
+    return o.write(s.data(), s.size());
 }
 
 /**
- * @brief Interface of json string-like classes.
+ * @cond detail
  **/
-class stringlike
+namespace detail
 {
-public:
-    virtual ~stringlike() {}
 
-    /**
-     * @return an unescaped string representation of this instance.
-     **/
-    virtual string to_json_string() const = 0;
-};
+/**
+ * @return a 64-bit FNV-1a hash of size bytes at data
+ **/
+inline std::uint64_t hash_bytes(const char *data, std::size_t size)
+{
+    std::uint64_t h = 0xcbf29ce484222325;
+    for (std::size_t i = 0; i < size; ++i)
+        h = (h ^ static_cast<unsigned char>(data[i])) * 0x100000001b3;
+    return h;
+}
 
+#ifdef JSON_SINGLE_THREADED
 /**
- * @brief Interface of json object-like classes.
+ * A plain counter with the interface of std::atomic, for builds in which
+ * values never cross threads.
  **/
-class objectlike
+class refcount
 {
+private:
+    std::size_t _n;
+
 public:
-    virtual ~objectlike() {}
+    refcount(std::size_t n)
+        : _n(n)
+    {
+    }
 
-    /**
-     * @return a representation of this instance as a json::object (i.e. std::map<string, json::value>).
-     **/
-    virtual object const &to_json_object() const = 0;
+    std::size_t load(std::memory_order) const { return _n; }
+
+    std::size_t fetch_add(std::size_t d, std::memory_order)
+    {
+        auto n = _n;
+        _n += d;
+        return n;
+    }
+
+    std::size_t fetch_sub(std::size_t d, std::memory_order)
+    {
+        auto n = _n;
+        _n -= d;
+        return n;
+    }
+
+    std::size_t fetch_or(std::size_t d, std::memory_order)
+    {
+        auto n = _n;
+        _n |= d;
+        return n;
+    }
 };
+#else
+using refcount = std::atomic<std::size_t>;
+#endif
 
 /**
- * @brief Interface of json array-like classes.
+ * The shared, immutable storage of a @ref key
  **/
-class arraylike
+struct key_rep
 {
-public:
-    virtual ~arraylike() {}
+    refcount refs{ 1 };
+    std::uint64_t hash;
+    string text;
 
-    /**
-     * @return a representation of this instance as a json::array (i.e. std::vector<json::value>).
-     **/
-    virtual array const &to_json_array() const = 0;
+    explicit key_rep(string_ref s)
+        : hash(hash_bytes(s.data(), s.size()))
+        , text(s.data(), s.size())
+    {
+    }
 };
 
+} // namespace detail
 /**
- * @brief basic exception related to json operations
+ * @endcond detail
  **/
-class exception : public std::exception
+
+/**
+ * @brief An immutable object key with a precomputed hash.
+ *
+ * Copies share one reference-counted string. Keys interned in a
+ * @ref key_table are shared by every object using them, and two keys from
+ * the same table compare by pointer.
+ **/
+class key
 {
-protected:
-    std::string msg;
+private:
+    detail::key_rep *_rep{ nullptr };
+
+    static string const &empty()
+    {
+        static const string s;
+        return s;
+    }
 
 public:
-    /**
-     * @brief construct an empty exception (not recommended, but meh)
-     **/
-    exception() {}
+    key() {}
 
     /**
-     * @brief construct a general json exception with a given message
-     * @param msg detail about the exception
+     * @brief make a key holding a copy of s
      **/
-    exception(const char *msg)
-        : msg(msg)
+    explicit key(string_ref s)
+        : _rep(new detail::key_rep(s))
     {
     }
 
-    /**
-     * @brief construct a general json exception with a given message
-     * @param msg detail about the exception
-     **/
-    exception(std::string const &msg)
-        : msg(msg)
+    key(key const &k)
+        : _rep(k._rep)
     {
+        if (_rep)
+            _rep->refs.fetch_add(1, std::memory_order_relaxed);
     }
 
-    virtual ~exception() {}
+    key(key &&k) noexcept
+        : _rep(k._rep)
+    {
+        k._rep = nullptr;
+    }
 
-    /**
-     * @return An message describing the exception.
-     **/
-    virtual const char *what() const noexcept
+    key &operator=(key k) noexcept
     {
-        return msg.c_str();
+        std::swap(_rep, k._rep);
+        return *this;
+    }
+
+    ~key()
+    {
+        if (_rep && _rep->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete _rep;
     }
+
+    string const &str() const { return _rep ? _rep->text : empty(); }
+    operator string const &() const { return str(); }
+    const char *data() const { return str().data(); }
+    std::size_t size() const { return str().size(); }
+
+    /**
+     * @return the hash of the key's characters
+     **/
+    std::uint64_t hash() const { return _rep ? _rep->hash : detail::hash_bytes(nullptr, 0); }
+
+    /**
+     * @return true if both keys share their storage, as interned keys do
+     **/
+    bool same(key const &k) const { return _rep == k._rep; }
 };
 
+inline bool operator==(key const &a, string_ref b)
+{
+    return a.size() == b.size() && !std::memcmp(a.data(), b.data(), b.size());
+}
+
+inline bool operator==(string_ref a, key const &b) { return b == a; }
+inline bool operator!=(key const &a, string_ref b) { return !(a == b); }
+inline bool operator!=(string_ref a, key const &b) { return !(b == a); }
+
+inline bool operator==(key const &a, key const &b)
+{
+    return a.same(b) || (a.hash() == b.hash() && a == string_ref(b.str()));
+}
+
+inline bool operator!=(key const &a, key const &b) { return !(a == b); }
+
+inline std::ostream &operator<<(std::ostream &o, key const &k)
+{
+    return o << k.str();
+}
+
 /**
- * @brief an exception for malformed json
+ * @brief A table of interned object keys, shared between parses.
+ *
+ * While an @ref intern_scope for the table is active, parsing into
+ * @ref ordered_object looks every key up in the table, so a key repeated
+ * across records is stored once and compared by pointer. Keys stay in the
+ * table until it is cleared or destroyed; objects holding them keep their
+ * own references.
+ *
+ * The table holds at most max_size() keys, JSON_MAX_INTERNED_KEYS unless
+ * given to the constructor, so input with ever new keys cannot grow it
+ * without bound. Once it is full, keys already in it are still shared and
+ * other keys are made as plain, uninterned @ref key objects.
+ *
+ * Only @ref ordered_object uses keys, so without JSON_ORDERED_OBJECT the
+ * default object type ignores the table and interning has no effect.
+ *
+ * @warning a table must not be used by several threads at once
  **/
-class bad_json : public exception
+class key_table
 {
+private:
+    std::vector<key> _slots;
+    std::size_t _size{ 0 };
+    std::size_t _max_size;
+
+    void grow()
+    {
+        std::vector<key> old(_slots.empty() ? 64 : _slots.size() * 2);
+        old.swap(_slots);
+        for (auto &k : old)
+        {
+            if (!k.size())
+                continue;
+            auto s = k.hash() & (_slots.size() - 1);
+            while (_slots[s].size())
+                s = (s + 1) & (_slots.size() - 1);
+            _slots[s] = std::move(k);
+        }
+    }
+
 public:
     /**
-     * @brief construct a default bad json exception
+     * @brief make an empty table
+     * @param max_size the most keys the table will hold
      **/
-    bad_json()
-        : exception("bad json exception: malformed json")
+    explicit key_table(std::size_t max_size = JSON_MAX_INTERNED_KEYS)
+        : _max_size(max_size)
     {
     }
 
     /**
-     * @brief construct a bad json exception with a given message
-     * @param msg detail about the exception
+     * @return the table's key for s, adding it if needed and there is room,
+     * or else a key of its own
      **/
-    bad_json(const char *msg)
-        : exception(msg)
+    key intern(string_ref s)
     {
+        if (!s.size())
+            return key();
+        if (_size < _max_size && (_size + 1) * 2 > _slots.size())
+            grow();
+        if (_slots.empty())
+            return key(s);
+        auto s_hash = detail::hash_bytes(s.data(), s.size());
+        auto i = s_hash & (_slots.size() - 1);
+        for (; _slots[i].size(); i = (i + 1) & (_slots.size() - 1))
+        {
+            if (_slots[i].hash() == s_hash && _slots[i] == s)
+                return _slots[i];
+        }
+        if (_size == _max_size)
+            return key(s);
+        ++_size;
+        return _slots[i] = key(s);
     }
 
     /**
-     * @brief construct a bad json exception with a given message
-     * @param msg detail about the exception
+     * @return the number of distinct keys in the table
      **/
-    bad_json(std::string const &msg)
-        : exception(msg)
+    std::size_t size() const { return _size; }
+
+    /**
+     * @return the most keys the table will hold
+     **/
+    std::size_t max_size() const { return _max_size; }
+
+    void clear()
     {
+        _slots.clear();
+        _size = 0;
     }
-
-    ~bad_json() {}
 };
 
 /**
@@ -238,909 +467,8042 @@ public:
 namespace detail
 {
 
-static const char *const bool_branch[]{ "false", "true" };
-static const char *const comma_branch[]{ "", ", " };
+inline key_table *&current_keys()
+{
+    static thread_local key_table *t = nullptr;
+    return t;
+}
 
-class value_t
+/**
+ * @return a key for s, interned if a table is in scope on this thread
+ **/
+inline key make_key(string_ref s)
 {
-public:
-    value_t() {}
-    virtual ~value_t() {}
-    virtual string json() const = 0;
-
-#define JSON_IS(type)                                                           \
-    virtual bool is_##type() const { return false; }                            \
-    virtual type const &get_##type() const { throw exception("invalid cast"); } \
-    virtual type &get_##type() { throw exception("invalid cast"); }
-    JSON_IS(array);
-    JSON_IS(bool);
-    JSON_IS(number);
-    JSON_IS(string);
-    JSON_IS(object);
-    virtual bool is_null() const { return false; }
-#undef JSON_IS
-};
+    if (auto t = current_keys())
+        return t->intern(s);
+    return key(s);
+}
+
+} // namespace detail
+/**
+ * @endcond detail
+ **/
 
-class number_wrapper : public value_t
+/**
+ * @brief Interns the keys of objects parsed on this thread while in scope.
+ *
+ * This only affects @ref ordered_object, so it does nothing unless
+ * JSON_ORDERED_OBJECT is defined.
+ *
+ * @code
+ * json::key_table keys;
+ * json::intern_scope scope(keys);
+ * for (auto const &record : json::document_stream(std::cin))
+ *     cache.push_back(record.data);
+ * @endcode
+ **/
+class intern_scope
 {
 private:
-    number *_value;
+    key_table *_previous;
 
 public:
-    number_wrapper(int v)
-        : _value(new number(v))
-    {
-    }
-    number_wrapper(double v)
-        : _value(new number(v))
-    {
-    }
-    ~number_wrapper()
+    explicit intern_scope(key_table &t)
+        : _previous(detail::current_keys())
     {
-        delete _value;
+        detail::current_keys() = &t;
     }
 
-public:
-    bool is_number() const { return true; }
-    number const &get_number() const { return *_value; }
-    number &get_number() { return *_value; }
-    string json() const
+    intern_scope(intern_scope const &) = delete;
+    intern_scope &operator=(intern_scope const &) = delete;
+
+    ~intern_scope()
     {
-        std::stringstream ss;
-        ss << *_value;
-        return ss.str();
+        detail::current_keys() = _previous;
     }
 };
 
-class string_wrapper : public value_t
+/**
+ * @brief A map from keys to T which keeps its members in insertion order
+ * in one contiguous vector.
+ *
+ * Small maps are searched linearly, which beats hashing for the handful of
+ * members most json objects have. Past index_threshold members, an
+ * open-addressing index of positions in the vector is kept alongside.
+ * Iteration, and so serialization, follows insertion order.
+ *
+ * The interface follows std::unordered_map where it matters for json.
+ * Keys must not be modified through iterators.
+ **/
+template <typename T>
+class ordered_map
 {
+public:
+    using key_type = json::key;
+    using mapped_type = T;
+    using value_type = std::pair<json::key, T>;
+    using size_type = std::size_t;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    static const size_type index_threshold = 16;
+
 private:
-    string *_value;
+    std::vector<value_type> _items;
+    // Positions in _items plus one, zero for an empty slot
+    std::vector<std::uint32_t> _slots;
 
-public:
-    string_wrapper(const char *v)
-        : _value(new string(v))
+    std::size_t mask() const { return _slots.size() - 1; }
+
+    void add_slot(size_type i)
     {
+        auto s = _items[i].first.hash() & mask();
+        while (_slots[s])
+            s = (s + 1) & mask();
+        _slots[s] = static_cast<std::uint32_t>(i + 1);
     }
-    string_wrapper(string const &v)
-        : _value(new string(v))
+
+    void reindex(size_type capacity)
     {
+        _slots.clear();
+        if (capacity <= index_threshold)
+            return;
+        size_type n = 2;
+        while (n < capacity * 2)
+            n *= 2;
+        _slots.assign(n, 0);
+        for (size_type i = 0; i < _items.size(); ++i)
+            add_slot(i);
     }
-    string_wrapper(stringlike const &v)
-        : _value(new string(v.to_json_string()))
+
+    size_type position(string_ref k, std::uint64_t hash, key const *interned) const
     {
+        if (_slots.empty())
+        {
+            for (size_type i = 0; i < _items.size(); ++i)
+            {
+                if ((interned && _items[i].first.same(*interned)) || _items[i].first == k)
+                    return i;
+            }
+            return _items.size();
+        }
+        for (auto s = hash & mask(); _slots[s]; s = (s + 1) & mask())
+        {
+            auto const &item = _items[_slots[s] - 1].first;
+            if ((interned && item.same(*interned)) || (item.hash() == hash && item == k))
+                return _slots[s] - 1;
+        }
+        return _items.size();
     }
 
-    ~string_wrapper()
+    size_type position(string_ref k) const
     {
-        delete _value;
+        return position(k, _slots.empty() ? 0 : detail::hash_bytes(k.data(), k.size()), nullptr);
     }
 
-public:
-    bool is_string() const { return true; }
-    string const &get_string() const { return *_value; }
-    string &get_string() { return *_value; }
-    string json() const
+    size_type position(json::key const &k) const
     {
-        std::stringstream ss;
-        ss << "\"" << escape(*_value) << "\"";
-        return ss.str();
+        return position(k.str(), k.hash(), &k);
     }
-};
 
-class array_wrapper : public value_t
-{
-private:
-    array *_value;
+    std::pair<iterator, bool> insert_new(size_type i, json::key &&k, T &&v)
+    {
+        if (i != _items.size())
+            return std::make_pair(_items.begin() + i, false);
+        _items.emplace_back(std::move(k), std::move(v));
+        if (_slots.empty() ? _items.size() > index_threshold : _items.size() * 2 > _slots.size())
+            reindex(_items.size() * 2);
+        else if (!_slots.empty())
+            add_slot(_items.size() - 1);
+        return std::make_pair(_items.end() - 1, true);
+    }
 
 public:
-    array_wrapper(array const &v)
-        : _value(new array(v))
+    ordered_map() {}
+
+    ordered_map(std::initializer_list<std::pair<string_ref, T>> items)
     {
+        for (auto const &i : items)
+            emplace(i.first, i.second);
     }
-    array_wrapper(arraylike const &v)
-        : _value(new array(v.to_json_array()))
+
+    iterator begin() { return _items.begin(); }
+    iterator end() { return _items.end(); }
+    const_iterator begin() const { return _items.begin(); }
+    const_iterator end() const { return _items.end(); }
+
+    size_type size() const { return _items.size(); }
+    bool empty() const { return _items.empty(); }
+
+    void clear()
     {
+        _items.clear();
+        _slots.clear();
     }
-    ~array_wrapper()
+
+    void reserve(size_type n)
     {
-        delete _value;
+        _items.reserve(n);
+        if (n > index_threshold && n * 2 > _slots.size())
+            reindex(n);
     }
 
-public:
-    bool is_array() const { return true; }
-    array const &get_array() const { return *_value; }
-    array &get_array() { return *_value; }
-    inline string json() const;
-};
+    iterator find(string_ref k) { return _items.begin() + position(k); }
+    iterator find(json::key const &k) { return _items.begin() + position(k); }
+    const_iterator find(string_ref k) const { return _items.begin() + position(k); }
+    const_iterator find(json::key const &k) const { return _items.begin() + position(k); }
+    size_type count(string_ref k) const { return position(k) != _items.size(); }
+    size_type count(json::key const &k) const { return position(k) != _items.size(); }
 
-class object_wrapper : public value_t
-{
-private:
-    object *_value;
+    T &at(string_ref k)
+    {
+        auto i = position(k);
+        if (i == _items.size())
+            throw std::out_of_range("ordered_map::at");
+        return _items[i].second;
+    }
 
-public:
-    object_wrapper(object const &v)
-        : _value(new object(v))
+    T const &at(string_ref k) const
     {
+        auto i = position(k);
+        if (i == _items.size())
+            throw std::out_of_range("ordered_map::at");
+        return _items[i].second;
     }
-    object_wrapper(objectlike const &v)
-        : _value(new object(v.to_json_object()))
+
+    T &operator[](string_ref k)
     {
+        auto i = position(k);
+        if (i != _items.size())
+            return _items[i].second;
+        return insert_new(i, detail::make_key(k), T()).first->second;
     }
-    ~object_wrapper()
+
+    T &operator[](json::key const &k)
     {
-        delete _value;
+        return insert_new(position(k), json::key(k), T()).first->second;
     }
 
-public:
-    bool is_object() const { return true; }
-    inline object const &get_object() const;
-    inline object &get_object();
-    inline string json() const;
-};
+    std::pair<iterator, bool> insert(value_type const &v)
+    {
+        return insert_new(position(v.first), json::key(v.first), T(v.second));
+    }
 
-class bool_wrapper : public value_t
-{
-private:
-    bool _value;
+    std::pair<iterator, bool> insert(value_type &&v)
+    {
+        return insert_new(position(v.first), std::move(v.first), std::move(v.second));
+    }
 
-public:
-    bool_wrapper(bool v)
-        : _value(v)
+    template <typename V>
+    std::pair<iterator, bool> emplace(string_ref k, V &&v)
     {
+        auto i = position(k);
+        if (i != _items.size())
+            return std::make_pair(_items.begin() + i, false);
+        return insert_new(i, detail::make_key(k), T(std::forward<V>(v)));
     }
-    ~bool_wrapper() {}
 
-public:
-    bool const &get_bool() const { return _value; }
-    bool &get_bool() { return _value; }
-    bool is_bool() const { return true; }
-    string json() const
+    template <typename V>
+    std::pair<iterator, bool> emplace(json::key const &k, V &&v)
     {
-        return bool_branch[_value];
+        return insert_new(position(k), json::key(k), T(std::forward<V>(v)));
     }
-};
 
-class null_wrapper : public value_t
-{
-public:
-    null_wrapper() {}
-    ~null_wrapper() {}
+    /**
+     * @brief remove a member, keeping the order of the others
+     **/
+    iterator erase(const_iterator pos)
+    {
+        auto i = pos - _items.cbegin();
+        _items.erase(_items.begin() + i);
+        if (!_slots.empty())
+            reindex(_items.size() * 2);
+        return _items.begin() + i;
+    }
 
-public:
-    bool is_null() const { return true; }
-    string json() const
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        auto i = first - _items.cbegin();
+        if (first == last)
+            return _items.begin() + i;
+        _items.erase(_items.begin() + i, _items.begin() + (last - _items.cbegin()));
+        if (!_slots.empty())
+            reindex(_items.size() * 2);
+        return _items.begin() + i;
+    }
+
+    size_type erase(string_ref k)
     {
-        return "null";
+        auto i = position(k);
+        if (i == _items.size())
+            return 0;
+        erase(_items.cbegin() + i);
+        return 1;
     }
 };
 
-} // namespace detail
 /**
- * @endcond detail
+ * @brief An insertion-ordered json object; see @ref ordered_map
  **/
+using ordered_object = ordered_map<value>;
 
+#ifdef JSON_ORDERED_OBJECT
 /**
- * @brief enumeration of the possible json value types
+ * @brief The json object is a @ref ordered_object
  **/
-enum ValueType
+using object = ordered_object;
+#else
+/**
+ * @brief The json object is really a std::unordered_map<string, @ref value>
+ *
+ * Define JSON_ORDERED_OBJECT before including json.hpp to use the
+ * insertion-ordered @ref ordered_object instead.
+ **/
+using object = std::unordered_map<string, value>;
+#endif
+
+/**
+ * @brief The array is really a std::vector<@ref value>
+ **/
+using array = std::vector<value>;
+
+/**
+ * @brief The number is really a double
+ *
+ * A @ref value may also hold integers exactly as int64 or uint64; see
+ * @ref NumberType.
+ **/
+using number = double;
+
+std::ostream &operator<<(std::ostream &, object const &);
+std::ostream &operator<<(std::ostream &, array const &);
+
+/**
+ * @cond detail
+ **/
+namespace detail
 {
-    JSON_ARRAY,
-    JSON_BOOL,
-    JSON_NULL,
-    JSON_NUMBER,
-    JSON_OBJECT,
-    JSON_STRING,
-};
 
 /**
- * @brief Represents any json data type.
+ * Output sink appending to a string.
  **/
-class value
+class string_sink
 {
-protected:
-    std::shared_ptr<detail::value_t> _value{ new detail::null_wrapper() };
-    ValueType _type{ JSON_NULL };
+private:
+    string &_out;
 
 public:
-    /**
-     * Construct an empty value
-     **/
-    value() {}
-
-    ////////////////////////////////////////// Array
-    /**
-     * Construct a value with an array (or std::vector<value>)
-     * @param x the array to store in the value
-     **/
-    value(array const &x)
-        : _value(new detail::array_wrapper(x))
-        , _type(JSON_ARRAY)
+    explicit string_sink(string &out)
+        : _out(out)
     {
     }
 
-    /**
-     * Construct a value with an @ref arraylike object
-     * @param x the array to store in the value
-     **/
-    value(arraylike const &x)
-        : _value(new detail::array_wrapper(x))
-        , _type(JSON_ARRAY)
+    void put(char c)
     {
+        _out += c;
     }
 
-    ////////////////////////////////////////// Bool
-    /**
-     * Construct a value with a bool
-     * @param x the bool to store in the value
-     **/
-    value(bool x)
-        : _value(new detail::bool_wrapper(x))
-        , _type(JSON_BOOL)
+    void append(const char *data, std::size_t size)
     {
+        _out.append(data, size);
     }
 
-    ////////////////////////////////////////// Number
-    /**
-     * Construct a value with a floating-point value
-     * @param x The floating-point value to store as a number
-     **/
-    value(double x)
-        : _value(new detail::number_wrapper(x))
-        , _type(JSON_NUMBER)
+    std::size_t written() const
     {
+        return _out.size();
     }
+};
 
-    /**
-     * Construct a value with an integral value
-     * @param x The integral value to store as a number
-     **/
-    value(int x)
-        : _value(new detail::number_wrapper(x))
-        , _type(JSON_NUMBER)
+/**
+ * Output sink writing to an ostream through a small local buffer.
+ **/
+class stream_sink
+{
+private:
+    std::ostream &_out;
+    char _buffer[1024];
+    std::size_t _size{ 0 };
+    std::size_t _flushed{ 0 };
+
+public:
+    explicit stream_sink(std::ostream &out)
+        : _out(out)
     {
     }
 
-    ////////////////////////////////////////// Object
-    /**
-     * Construct a value with a json object (or std::map<string, value>)
-     * @param x The object to store in the value
-     **/
-    value(object const &x)
-        : _value(new detail::object_wrapper(x))
-        , _type(JSON_OBJECT)
+    stream_sink(stream_sink const &) = delete;
+    stream_sink &operator=(stream_sink const &) = delete;
+
+    ~stream_sink()
     {
+        flush();
     }
 
-    /**
-     * Construct a value with an @ref objectlike object
-     * @param x The object to store in the value
-     **/
-    value(objectlike const &x)
-        : _value(new detail::object_wrapper(x))
-        , _type(JSON_OBJECT)
+    void put(char c)
     {
+        if (_size == sizeof(_buffer))
+            flush();
+        _buffer[_size++] = c;
     }
 
-    ////////////////////////////////////////// String
-    /**
-     * Construct a value with a string
-     * @param x The string to store in the value
-     **/
-    value(string const &x)
-        : _value(new detail::string_wrapper(x))
-        , _type(JSON_STRING)
+    void append(const char *data, std::size_t size)
     {
+        if (_size + size > sizeof(_buffer))
+        {
+            flush();
+            if (size > sizeof(_buffer))
+            {
+                _out.write(data, size);
+                _flushed += size;
+                return;
+            }
+        }
+        std::memcpy(_buffer + _size, data, size);
+        _size += size;
     }
 
-    /**
-     * Construct a value with a null-terminated C-string
-     * @param x The string to store in the value
-     **/
-    value(const char *const &x)
-        : _value(new detail::string_wrapper(x))
-        , _type(JSON_STRING)
+    void flush()
     {
+        _out.write(_buffer, _size);
+        _flushed += _size;
+        _size = 0;
     }
 
-    /**
-     * Construct a value with a @ref stringlike object
-     * @param x The string to store in the value
-     **/
-    value(stringlike const &x)
-        : _value(new detail::string_wrapper(x))
-        , _type(JSON_STRING)
+    std::size_t written() const
     {
+        return _flushed + _size;
     }
+};
 
-public:
-    virtual ~value() {}
+inline unsigned trailing_zeros(std::uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    unsigned n = 0;
+    for (; !(x & 1); x >>= 1)
+        ++n;
+    return n;
+#endif
+}
 
-    /**
-     * Copy constructor
-     * @param v the value to copy
-     **/
-    value(value const &v)
-        : _value(v._value)
-        , _type(v._type)
-    {
-    }
+inline void multiply_128(std::uint64_t a, std::uint64_t b, std::uint64_t &hi, std::uint64_t &lo)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    hi = static_cast<std::uint64_t>(r >> 64);
+    lo = static_cast<std::uint64_t>(r);
+#else
+    std::uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+    std::uint64_t b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+    std::uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi, hl = a_hi * b_lo, hh = a_hi * b_hi;
+    std::uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+    hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    lo = (mid << 32) | (ll & 0xFFFFFFFF);
+#endif
+}
 
-    /**
-     * Copy assignment operator
-     * @param v the value to copy
-     * @return a reference to this object
-     **/
-    inline value &operator=(value const &v)
+inline int leading_zeros(std::uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    for (std::uint64_t bit = std::uint64_t(1) << 63; !(x & bit); bit >>= 1)
+        ++n;
+    return n;
+#endif
+}
+
+#if defined(__ARM_NEON)
+// One nibble per byte of a comparison result, in memory order
+inline std::uint64_t neon_mask(uint8x16_t m)
+{
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+}
+#endif
+
+/**
+ * @return the first character in [p, end) which must be escaped in a json
+ * string: '"', '\\' or a control character; end if there is none
+ **/
+inline const char *find_escape(const char *p, const char *end)
+{
+#if defined(__AVX2__)
+    for (; end - p >= 32; p += 32)
     {
-        _value = v._value;
-        _type = v._type;
-        return *this;
+        auto c = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+        auto hit = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\\'))),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(c, _mm256_set1_epi8(0x1f)), c));
+        auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(hit));
+        if (mask)
+            return p + trailing_zeros(mask);
     }
-
-public:
-    /**
-     * @return the value represented in json string form
-     **/
-    inline string json() const
+#elif defined(__SSE2__)
+    for (; end - p >= 16; p += 16)
     {
-        return _value->json();
+        auto c = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+        auto hit = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('"')), _mm_cmpeq_epi8(c, _mm_set1_epi8('\\'))),
+            _mm_cmpeq_epi8(_mm_min_epu8(c, _mm_set1_epi8(0x1f)), c));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        if (mask)
+            return p + trailing_zeros(mask);
     }
-
-    /**
-     * @return the json @ref ValueType of the value
-     */
-    inline ValueType type() const
+#elif defined(__ARM_NEON)
+    for (; end - p >= 16; p += 16)
     {
-        return _type;
+        auto c = vld1q_u8(reinterpret_cast<std::uint8_t const *>(p));
+        auto hit = vorrq_u8(
+            vorrq_u8(vceqq_u8(c, vdupq_n_u8('"')), vceqq_u8(c, vdupq_n_u8('\\'))),
+            vcltq_u8(c, vdupq_n_u8(0x20)));
+        auto mask = neon_mask(hit);
+        if (mask)
+            return p + (trailing_zeros(mask) >> 2);
     }
-
-    /**
-     * @return true if the value represents an array
-     **/
-    inline bool is_array() const { return _value->is_array(); }
-    array const &get_array() const { return _value->get_array(); }
-    array &get_array() { return _value->get_array(); }
-    explicit operator array &() { return _value->get_array(); }
-
-    /**
-     * @return true if the value represents a bool
-     **/
-    inline bool is_bool() const { return _value->is_bool(); }
-    bool const get_bool() const { return _value->get_bool(); }
-    bool get_bool() { return _value->get_bool(); }
-
-    /**
-     * @return true if the value is null
-     **/
-    inline bool is_null() const { return _value->is_null(); }
-
-    /**
-     * @return true if the value represents a number
-     **/
-    inline bool is_number() const { return _value->is_number(); }
-    number const &get_number() const { return _value->get_number(); }
-    number &get_number() { return _value->get_number(); }
-
-    /**
-     * @return true if the value represents an object
-     **/
-    inline bool is_object() const { return _value->is_object(); }
-    object const &get_object() const { return _value->get_object(); }
-    object &get_object() { return _value->get_object(); }
-
-    /**
-     * @return true if the value represents a string
-     **/
-    inline bool is_string() const { return _value->is_string(); }
-    string const &get_string() const { return _value->get_string(); }
-    string &get_string() { return _value->get_string(); }
-};
+#endif
+    while (p != end && *p != '"' && *p != '\\' && static_cast<unsigned char>(*p) >= 0x20)
+        ++p;
+    return p;
+}
 
 /**
- * @brief Put a json @ref value to an ostream object as json
+ * @return for each character, the letter of its escape sequence: 'u' for
+ * control characters written as \\u00XX, 0 for characters used as is
  **/
-inline std::ostream &operator<<(std::ostream &o, value const &v)
+inline const char *escape_table()
 {
-    o << v.json();
-    return o;
+    static const char table[256] = {
+        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+        0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\',
+    };
+    return table;
 }
 
 /**
- * @brief Put a json @ref array to an output stream as json
+ * @return for each character following a backslash, the character the
+ * escape stands for; 0 for 'u' and invalid escapes
  **/
-inline std::ostream &operator<<(std::ostream &o, array const &v)
+inline const char *unescape_table()
 {
+    static const char table[256] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '/',
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+        0, 0, '\b', 0, 0, 0, '\f', 0, 0, 0, 0, 0, 0, 0, '\n', 0,
+        0, 0, '\r', 0, '\t',
+    };
+    return table;
+}
 
-    size_t size{ v.size() }, count{ 0 };
-    o << "[";
-    for (auto const &i : v)
+/**
+ * Write the escaped form of [data, data + size) to a sink, copying runs
+ * that need no escaping in one piece.
+ **/
+template <typename Sink>
+void escape_into(Sink &sink, const char *data, std::size_t size)
+{
+    static const char hex[] = "0123456789abcdef";
+    auto run = data, end = data + size;
+    for (auto c = find_escape(run, end); c != end; c = find_escape(run, end))
     {
-        o << i.json();
-        o << detail::comma_branch[++count < size];
+        sink.append(run, c - run);
+        auto u = static_cast<unsigned char>(*c);
+        char e = escape_table()[u];
+        if (e == 'u')
+        {
+            char seq[] = { '\\', 'u', '0', '0', hex[u >> 4], hex[u & 15] };
+            sink.append(seq, sizeof(seq));
+        }
+        else
+        {
+            char seq[] = { '\\', e };
+            sink.append(seq, sizeof(seq));
+        }
+        run = c + 1;
     }
-    o << "]";
-
-    return o;
+    sink.append(run, end - run);
 }
 
 /**
- * @brief Put a json @ref object to an output stream as json
- */
-inline std::ostream &operator<<(std::ostream &o, object const &v)
+ * Read the four hex digits of a \\u escape at p.
+ * @return false if they are missing or malformed
+ **/
+inline bool read_hex4(const char *p, const char *end, unsigned &out)
 {
-
-    size_t size{ v.size() }, count{ 0 };
-
-    o << "{";
-    for (auto const &i : v)
+    if (end - p < 4)
+        return false;
+    out = 0;
+    for (int i = 0; i < 4; ++i)
     {
-        o << "\"" << escape(i.first) << "\": ";
-        o << i.second;
-        o << detail::comma_branch[++count < size];
+        char c = p[i];
+        unsigned d;
+        if (c >= '0' && c <= '9')
+            d = c - '0';
+        else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+            d = (c | 0x20) - 'a' + 10;
+        else
+            return false;
+        out = out << 4 | d;
     }
-    o << "}";
-
-    return o;
+    return true;
 }
 
 /**
- * @cond detail
+ * Write a code point as UTF-8.
+ * @return the end of the written bytes
  **/
-namespace detail
-{
-
-inline bool is_whitespace(char c)
+inline char *put_utf8(char *out, unsigned cp)
 {
-    return c == ' ' || c == '\r' || c == '\n' || c == '\t';
-}
+    if (cp < 0x80)
+    {
+        *out++ = static_cast<char>(cp);
+    }
+    else if (cp < 0x800)
+    {
+        *out++ = static_cast<char>(0xc0 | cp >> 6);
+        *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    else if (cp < 0x10000)
+    {
+        *out++ = static_cast<char>(0xe0 | cp >> 12);
+        *out++ = static_cast<char>(0x80 | (cp >> 6 & 0x3f));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    else
+    {
+        *out++ = static_cast<char>(0xf0 | cp >> 18);
+        *out++ = static_cast<char>(0x80 | (cp >> 12 & 0x3f));
+        *out++ = static_cast<char>(0x80 | (cp >> 6 & 0x3f));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    return out;
+}
+
+/**
+ * Decode the escaped characters [begin, end) to out, copying the runs
+ * between backslashes in bulk. The decoded form is never longer, so out may
+ * be begin itself.
+ *
+ * Escapes are decoded leniently: an unknown escape keeps the character
+ * after the backslash, and a lone surrogate becomes U+FFFD.
+ *
+ * @return the end of the decoded characters
+ **/
+inline char *unescape_to(char *out, const char *begin, const char *end)
+{
+    while (begin != end)
+    {
+        auto bs = static_cast<const char *>(std::memchr(begin, '\\', end - begin));
+        if (!bs)
+            bs = end;
+        if (out != begin)
+            std::memmove(out, begin, bs - begin);
+        out += bs - begin;
+        if (bs == end || bs + 1 == end)
+            break;
+        char c = bs[1];
+        begin = bs + 2;
+        if (char d = unescape_table()[static_cast<unsigned char>(c)])
+        {
+            *out++ = d;
+            continue;
+        }
+        unsigned cp;
+        if (c != 'u' || !read_hex4(begin, end, cp))
+        {
+            *out++ = c;
+            continue;
+        }
+        begin += 4;
+        if (cp >= 0xd800 && cp < 0xe000)
+        {
+            unsigned low;
+            if (cp < 0xdc00 && end - begin >= 6 && begin[0] == '\\' && begin[1] == 'u' && read_hex4(begin + 2, end, low) && low >= 0xdc00 && low < 0xe000)
+            {
+                cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                begin += 6;
+            }
+            else
+            {
+                cp = 0xfffd;
+            }
+        }
+        out = put_utf8(out, cp);
+    }
+    return out;
+}
+
+/**
+ * Append the unescaped form of the escaped characters [begin, end) to out.
+ **/
+inline void unescape_into(string &out, const char *begin, const char *end)
+{
+    auto n = out.size();
+    out.resize(n + (end - begin));
+    auto last = unescape_to(&out[0] + n, begin, end);
+    out.resize(last - out.data());
+}
+
+/*
+ * Shortest round-trip formatting of doubles and floats with Grisu2
+ * (Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with
+ * Integers", 2010). The digits always read back as the same number, and
+ * are the shortest such digits for all but a tiny fraction of inputs.
+ */
+
+// A floating-point number f * 2^e with a 64-bit significand
+struct diy_fp
+{
+    std::uint64_t f;
+    int e;
+};
+
+inline diy_fp multiply(diy_fp x, diy_fp y)
+{
+    std::uint64_t hi, lo;
+    multiply_128(x.f, y.f, hi, lo);
+    // Round the upper half to nearest
+    return diy_fp{ hi + (lo >> 63), x.e + y.e + 64 };
+}
+
+inline diy_fp normalize(diy_fp x)
+{
+    int shift = leading_zeros(x.f);
+    return diy_fp{ x.f << shift, x.e - shift };
+}
+
+/**
+ * The value of v and the boundaries halfway to its neighbours, scaled to
+ * the exponent of the normalized upper boundary
+ **/
+struct fp_boundaries
+{
+    diy_fp w;
+    diy_fp minus;
+    diy_fp plus;
+};
+
+template <typename Float>
+fp_boundaries compute_boundaries(Float v)
+{
+    using bits_type = typename std::conditional<sizeof(Float) == 8, std::uint64_t, std::uint32_t>::type;
+    const int precision = std::numeric_limits<Float>::digits; // including the hidden bit
+    const int bias = std::numeric_limits<Float>::max_exponent - 1 + (precision - 1);
+    const std::uint64_t hidden_bit = std::uint64_t(1) << (precision - 1);
+
+    bits_type bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    std::uint64_t fraction = bits & (hidden_bit - 1);
+    int biased_exponent = static_cast<int>(bits >> (precision - 1)) & ((1 << (sizeof(Float) * 8 - precision)) - 1);
+
+    diy_fp x = biased_exponent == 0 ? diy_fp{ fraction, 1 - bias } : diy_fp{ fraction + hidden_bit, biased_exponent - bias };
+
+    // The lower neighbour is closer when v is a power of two above the
+    // smallest normal number
+    bool lower_closer = fraction == 0 && biased_exponent > 1;
+    diy_fp plus = normalize(diy_fp{ 2 * x.f + 1, x.e - 1 });
+    diy_fp minus = lower_closer ? diy_fp{ 4 * x.f - 1, x.e - 2 } : diy_fp{ 2 * x.f - 1, x.e - 1 };
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+    return fp_boundaries{ normalize(x), minus, plus };
+}
+
+/**
+ * A normalized power of ten c = f * 2^e = 10^k
+ **/
+struct cached_power
+{
+    std::uint64_t f;
+    int e;
+    int k;
+};
+
+/**
+ * @return a power of ten c such that e + c.e + 64 falls in [-60, -32], so
+ * that the digits of a number with binary exponent e scaled by c can be
+ * produced with 32- and 64-bit arithmetic
+ **/
+inline cached_power cached_power_for(int e)
+{
+    static const cached_power powers[] = {
+        { 0xAB70FE17C79AC6CA, -1060, -300 },
+        { 0xFF77B1FCBEBCDC4F, -1034, -292 },
+        { 0xBE5691EF416BD60C, -1007, -284 },
+        { 0x8DD01FAD907FFC3C, -980, -276 },
+        { 0xD3515C2831559A83, -954, -268 },
+        { 0x9D71AC8FADA6C9B5, -927, -260 },
+        { 0xEA9C227723EE8BCB, -901, -252 },
+        { 0xAECC49914078536D, -874, -244 },
+        { 0x823C12795DB6CE57, -847, -236 },
+        { 0xC21094364DFB5637, -821, -228 },
+        { 0x9096EA6F3848984F, -794, -220 },
+        { 0xD77485CB25823AC7, -768, -212 },
+        { 0xA086CFCD97BF97F4, -741, -204 },
+        { 0xEF340A98172AACE5, -715, -196 },
+        { 0xB23867FB2A35B28E, -688, -188 },
+        { 0x84C8D4DFD2C63F3B, -661, -180 },
+        { 0xC5DD44271AD3CDBA, -635, -172 },
+        { 0x936B9FCEBB25C996, -608, -164 },
+        { 0xDBAC6C247D62A584, -582, -156 },
+        { 0xA3AB66580D5FDAF6, -555, -148 },
+        { 0xF3E2F893DEC3F126, -529, -140 },
+        { 0xB5B5ADA8AAFF80B8, -502, -132 },
+        { 0x87625F056C7C4A8B, -475, -124 },
+        { 0xC9BCFF6034C13053, -449, -116 },
+        { 0x964E858C91BA2655, -422, -108 },
+        { 0xDFF9772470297EBD, -396, -100 },
+        { 0xA6DFBD9FB8E5B88F, -369, -92 },
+        { 0xF8A95FCF88747D94, -343, -84 },
+        { 0xB94470938FA89BCF, -316, -76 },
+        { 0x8A08F0F8BF0F156B, -289, -68 },
+        { 0xCDB02555653131B6, -263, -60 },
+        { 0x993FE2C6D07B7FAC, -236, -52 },
+        { 0xE45C10C42A2B3B06, -210, -44 },
+        { 0xAA242499697392D3, -183, -36 },
+        { 0xFD87B5F28300CA0E, -157, -28 },
+        { 0xBCE5086492111AEB, -130, -20 },
+        { 0x8CBCCC096F5088CC, -103, -12 },
+        { 0xD1B71758E219652C, -77, -4 },
+        { 0x9C40000000000000, -50, 4 },
+        { 0xE8D4A51000000000, -24, 12 },
+        { 0xAD78EBC5AC620000, 3, 20 },
+        { 0x813F3978F8940984, 30, 28 },
+        { 0xC097CE7BC90715B3, 56, 36 },
+        { 0x8F7E32CE7BEA5C70, 83, 44 },
+        { 0xD5D238A4ABE98068, 109, 52 },
+        { 0x9F4F2726179A2245, 136, 60 },
+        { 0xED63A231D4C4FB27, 162, 68 },
+        { 0xB0DE65388CC8ADA8, 189, 76 },
+        { 0x83C7088E1AAB65DB, 216, 84 },
+        { 0xC45D1DF942711D9A, 242, 92 },
+        { 0x924D692CA61BE758, 269, 100 },
+        { 0xDA01EE641A708DEA, 295, 108 },
+        { 0xA26DA3999AEF774A, 322, 116 },
+        { 0xF209787BB47D6B85, 348, 124 },
+        { 0xB454E4A179DD1877, 375, 132 },
+        { 0x865B86925B9BC5C2, 402, 140 },
+        { 0xC83553C5C8965D3D, 428, 148 },
+        { 0x952AB45CFA97A0B3, 455, 156 },
+        { 0xDE469FBD99A05FE3, 481, 164 },
+        { 0xA59BC234DB398C25, 508, 172 },
+        { 0xF6C69A72A3989F5C, 534, 180 },
+        { 0xB7DCBF5354E9BECE, 561, 188 },
+        { 0x88FCF317F22241E2, 588, 196 },
+        { 0xCC20CE9BD35C78A5, 614, 204 },
+        { 0x98165AF37B2153DF, 641, 212 },
+        { 0xE2A0B5DC971F303A, 667, 220 },
+        { 0xA8D9D1535CE3B396, 694, 228 },
+        { 0xFB9B7CD9A4A7443C, 720, 236 },
+        { 0xBB764C4CA7A44410, 747, 244 },
+        { 0x8BAB8EEFB6409C1A, 774, 252 },
+        { 0xD01FEF10A657842C, 800, 260 },
+        { 0x9B10A4E5E9913129, 827, 268 },
+        { 0xE7109BFBA19C0C9D, 853, 276 },
+        { 0xAC2820D9623BF429, 880, 284 },
+        { 0x80444B5E7AA7CF85, 907, 292 },
+        { 0xBF21E44003ACDD2D, 933, 300 },
+        { 0x8E679C2F5E44FF8F, 960, 308 },
+        { 0xD433179D9C8CB841, 986, 316 },
+        { 0x9E19DB92B4E31BA9, 1013, 324 },
+    };
+    const int alpha = -60;
+    int f = alpha - e - 1;
+    // ceil(f * log10(2))
+    int k = (f * 78913) / (1 << 18) + (f > 0);
+    int index = (300 + k + 7) / 8;
+    return powers[index];
+}
+
+inline int digits10(std::uint32_t n, std::uint32_t &pow10)
+{
+    int digits = 10;
+    for (pow10 = 1000000000; pow10 > n && digits > 1; pow10 /= 10)
+        --digits;
+    return digits;
+}
+
+// Move the last digit towards w while that stays within the boundaries
+inline void grisu2_round(char *buffer, int length, std::uint64_t dist, std::uint64_t delta, std::uint64_t rest, std::uint64_t ten_k)
+{
+    while (rest < dist && delta - rest >= ten_k && (rest + ten_k < dist || dist - rest > rest + ten_k - dist))
+    {
+        --buffer[length - 1];
+        rest += ten_k;
+    }
+}
+
+/**
+ * Generate the digits of w, between minus and plus, into buffer
+ * @return the number of digits; decimal_exponent is adjusted so that the
+ * number is digits * 10^decimal_exponent
+ **/
+inline int grisu2_digits(char *buffer, int &decimal_exponent, diy_fp minus, diy_fp w, diy_fp plus)
+{
+    std::uint64_t delta = plus.f - minus.f;
+    std::uint64_t dist = plus.f - w.f;
+    unsigned shift = static_cast<unsigned>(-plus.e);
+    std::uint64_t one = std::uint64_t(1) << shift;
+
+    auto p1 = static_cast<std::uint32_t>(plus.f >> shift);
+    std::uint64_t p2 = plus.f & (one - 1);
+    int length = 0;
+
+    std::uint32_t pow10;
+    for (int n = digits10(p1, pow10); n > 0; pow10 /= 10)
+    {
+        buffer[length++] = static_cast<char>('0' + p1 / pow10);
+        p1 %= pow10;
+        --n;
+        std::uint64_t rest = (static_cast<std::uint64_t>(p1) << shift) + p2;
+        if (rest <= delta)
+        {
+            decimal_exponent += n;
+            grisu2_round(buffer, length, dist, delta, rest, static_cast<std::uint64_t>(pow10) << shift);
+            return length;
+        }
+    }
+
+    int m = 0;
+    for (;;)
+    {
+        p2 *= 10;
+        buffer[length++] = static_cast<char>('0' + (p2 >> shift));
+        p2 &= one - 1;
+        ++m;
+        delta *= 10;
+        dist *= 10;
+        if (p2 <= delta)
+            break;
+    }
+    decimal_exponent -= m;
+    grisu2_round(buffer, length, dist, delta, p2, one);
+    return length;
+}
+
+/**
+ * The shortest digits of a finite positive v
+ * @return the number of digits; the number is digits * 10^decimal_exponent
+ **/
+template <typename Float>
+int shortest_digits(char *buffer, int &decimal_exponent, Float v)
+{
+    auto b = compute_boundaries(v);
+    auto c = cached_power_for(b.plus.e);
+    diy_fp scale{ c.f, c.e };
+    diy_fp w = multiply(b.w, scale), minus = multiply(b.minus, scale), plus = multiply(b.plus, scale);
+    // Shrink the boundaries by the possible rounding error of the products
+    minus.f += 1;
+    plus.f -= 1;
+    decimal_exponent = -c.k;
+    return grisu2_digits(buffer, decimal_exponent, minus, w, plus);
+}
+
+/**
+ * Lay out digits * 10^decimal_exponent as ECMAScript's Number::toString
+ * does: plain digits from 1e-7 up to 1e21, exponential outside that.
+ * @return the end of the text; buffer must hold 32 characters
+ **/
+inline char *format_digits(char *buffer, int length, int decimal_exponent)
+{
+    int point = length + decimal_exponent; // digits before the decimal point
+    if (length <= point && point <= 21)
+    {
+        std::memset(buffer + length, '0', point - length);
+        return buffer + point;
+    }
+    if (0 < point && point <= 21)
+    {
+        std::memmove(buffer + point + 1, buffer + point, length - point);
+        buffer[point] = '.';
+        return buffer + length + 1;
+    }
+    if (-6 < point && point <= 0)
+    {
+        std::memmove(buffer + 2 - point, buffer, length);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        std::memset(buffer + 2, '0', -point);
+        return buffer + 2 - point + length;
+    }
+    auto p = buffer + 1;
+    if (length > 1)
+    {
+        std::memmove(buffer + 2, buffer + 1, length - 1);
+        buffer[1] = '.';
+        p = buffer + length + 1;
+    }
+    *p++ = 'e';
+    int e = point - 1;
+    *p++ = e < 0 ? '-' : '+';
+    if (e < 0)
+        e = -e;
+    if (e >= 100)
+        *p++ = static_cast<char>('0' + e / 100);
+    if (e >= 10)
+        *p++ = static_cast<char>('0' + e / 10 % 10);
+    *p++ = static_cast<char>('0' + e % 10);
+    return p;
+}
+
+/**
+ * Write the shortest text reading back as the finite number v
+ * @return the end of the text; buffer must hold 32 characters
+ **/
+template <typename Float>
+char *format_shortest(char *buffer, Float v)
+{
+    if (std::signbit(v))
+    {
+        *buffer++ = '-';
+        v = -v;
+    }
+    if (v == 0)
+    {
+        *buffer = '0';
+        return buffer + 1;
+    }
+    int decimal_exponent;
+    int length = shortest_digits(buffer, decimal_exponent, v);
+    return format_digits(buffer, length, decimal_exponent);
+}
+
+} // namespace detail
+/**
+ * @endcond detail
+ **/
+
+/**
+ * @brief Create an escaped string from an unescaped string.
+ * @param value an unescaped string
+ * @return an escaped string
+ **/
+inline string escape(string const &value)
+{
+    if (detail::find_escape(value.data(), value.data() + value.size()) == value.data() + value.size())
+        return value;
+    string rv;
+    rv.reserve(value.size());
+    detail::string_sink sink(rv);
+    detail::escape_into(sink, value.data(), value.size());
+    return rv;
+}
+
+/**
+ * @brief Create an unescaped string from an escaped string.
+ * @param value an escaped string
+ * @return an unescaped string
+ **/
+inline string unescape(string const &value)
+{
+    string rv;
+    detail::unescape_into(rv, value.data(), value.data() + value.size());
+    return rv;
+}
+
+/**
+ * @brief Interface of json string-like classes.
+ **/
+class stringlike
+{
+public:
+    virtual ~stringlike() {}
+
+    /**
+     * @return an unescaped string representation of this instance.
+     **/
+    virtual string to_json_string() const = 0;
+};
+
+/**
+ * @brief Interface of json object-like classes.
+ **/
+class objectlike
+{
+public:
+    virtual ~objectlike() {}
+
+    /**
+     * @return a representation of this instance as a json::object (i.e. std::map<string, json::value>).
+     **/
+    virtual object const &to_json_object() const = 0;
+};
+
+/**
+ * @brief Interface of json array-like classes.
+ **/
+class arraylike
+{
+public:
+    virtual ~arraylike() {}
+
+    /**
+     * @return a representation of this instance as a json::array (i.e. std::vector<json::value>).
+     **/
+    virtual array const &to_json_array() const = 0;
+};
+
+/**
+ * @brief basic exception related to json operations
+ **/
+class exception : public std::exception
+{
+protected:
+    std::string msg;
+
+public:
+    /**
+     * @brief construct an empty exception (not recommended, but meh)
+     **/
+    exception() {}
+
+    /**
+     * @brief construct a general json exception with a given message
+     * @param msg detail about the exception
+     **/
+    exception(const char *msg)
+        : msg(msg)
+    {
+    }
+
+    /**
+     * @brief construct a general json exception with a given message
+     * @param msg detail about the exception
+     **/
+    exception(std::string const &msg)
+        : msg(msg)
+    {
+    }
+
+    virtual ~exception() {}
+
+    /**
+     * @return An message describing the exception.
+     **/
+    virtual const char *what() const noexcept
+    {
+        return msg.c_str();
+    }
+};
+
+/**
+ * @brief an exception for malformed json
+ **/
+class bad_json : public exception
+{
+public:
+    /**
+     * @brief construct a default bad json exception
+     **/
+    bad_json()
+        : exception("bad json exception: malformed json")
+    {
+    }
+
+    /**
+     * @brief construct a bad json exception with a given message
+     * @param msg detail about the exception
+     **/
+    bad_json(const char *msg)
+        : exception(msg)
+    {
+    }
+
+    /**
+     * @brief construct a bad json exception with a given message
+     * @param msg detail about the exception
+     **/
+    bad_json(std::string const &msg)
+        : exception(msg)
+    {
+    }
+
+    ~bad_json() {}
+};
+
+/**
+ * @brief A monotonic memory arena.
+ *
+ * Memory is handed out by bumping a pointer through a list of blocks and
+ * is only given back all at once, either by @ref reset (which keeps the
+ * blocks for reuse) or by destroying the arena.
+ **/
+class arena
+{
+private:
+    struct block
+    {
+        char *data;
+        std::size_t size;
+    };
+
+    std::vector<block> _blocks;
+    std::size_t _block_size;
+    std::size_t _current{ 0 };
+    std::size_t _offset{ 0 };
+
+public:
+    /**
+     * @brief construct an empty arena
+     * @param block_size the size of each block requested from the heap
+     **/
+    explicit arena(std::size_t block_size = 64 * 1024)
+        : _block_size(block_size)
+    {
+    }
+
+    arena(arena const &) = delete;
+    arena &operator=(arena const &) = delete;
+
+    ~arena()
+    {
+        for (auto &b : _blocks)
+            ::operator delete(b.data);
+    }
+
+    /**
+     * @brief allocate memory from the arena
+     * @param size the number of bytes to allocate
+     * @param align the required alignment, a power of two
+     * @return a pointer to the memory, valid until the next @ref reset
+     **/
+    void *allocate(std::size_t size, std::size_t align = alignof(std::max_align_t))
+    {
+        while (_current < _blocks.size())
+        {
+            auto &b = _blocks[_current];
+            auto offset = (_offset + align - 1) & ~(align - 1);
+            if (offset + size <= b.size)
+            {
+                _offset = offset + size;
+                return b.data + offset;
+            }
+            ++_current;
+            _offset = 0;
+        }
+        auto n = std::max(_block_size, size + align);
+        _blocks.push_back(block{ static_cast<char *>(::operator new(n)), n });
+        _current = _blocks.size() - 1;
+        _offset = 0;
+        return allocate(size, align);
+    }
+
+    /**
+     * @brief release everything allocated so far, keeping the blocks
+     **/
+    void reset()
+    {
+        _current = 0;
+        _offset = 0;
+    }
+
+    /**
+     * @return the number of bytes held by the arena
+     **/
+    std::size_t capacity() const
+    {
+        std::size_t n = 0;
+        for (auto const &b : _blocks)
+            n += b.size;
+        return n;
+    }
+};
+
+/**
+ * @cond detail
+ **/
+namespace detail
+{
+
+static const char *const bool_branch[]{ "false", "true" };
+
+/**
+ * Reference-counted holder for the heap-backed json types. The count and
+ * the payload share a single allocation. Boxes made while an arena is
+ * active set the top bit of the count and leave their memory to the arena.
+ **/
+template <typename T>
+struct box
+{
+    static const std::size_t arena_bit = ~(~std::size_t(0) >> 1);
+
+    refcount refs{ 1 };
+    T value;
+
+    template <typename... Args>
+    explicit box(Args &&... args)
+        : value(std::forward<Args>(args)...)
+    {
+    }
+};
+
+inline arena *&current_arena()
+{
+    static thread_local arena *a = nullptr;
+    return a;
+}
+
+/**
+ * Routes box allocations on this thread to an arena while in scope.
+ **/
+class arena_scope
+{
+private:
+    arena *_previous;
+
+public:
+    explicit arena_scope(arena &a)
+        : _previous(current_arena())
+    {
+        current_arena() = &a;
+    }
+
+    ~arena_scope()
+    {
+        current_arena() = _previous;
+    }
+};
+
+template <typename T, typename... Args>
+inline box<T> *make_box(Args &&... args)
+{
+    if (auto a = current_arena())
+    {
+        auto b = new (a->allocate(sizeof(box<T>), alignof(box<T>))) box<T>(std::forward<Args>(args)...);
+        b->refs.fetch_or(box<T>::arena_bit, std::memory_order_relaxed);
+        return b;
+    }
+    return new box<T>(std::forward<Args>(args)...);
+}
+
+/**
+ * Take a reference to b for a new owner. A box in an arena goes away with
+ * the arena, so the new owner gets a heap copy of it instead; copying a
+ * container copies the arena boxes inside it the same way.
+ **/
+template <typename T>
+inline void retain(box<T> *&b)
+{
+    if (b->refs.load(std::memory_order_relaxed) & box<T>::arena_bit)
+        b = new box<T>(b->value);
+    else
+        b->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename T>
+inline void release(box<T> *b)
+{
+    auto refs = b->refs.fetch_sub(1, std::memory_order_acq_rel);
+    if (refs == 1)
+        delete b;
+    else if (refs == (box<T>::arena_bit | 1))
+        b->~box();
+}
+
+/**
+ * @return true if b has no other owner, so that it may be modified
+ **/
+template <typename T>
+inline bool unique(box<T> const *b)
+{
+    return (b->refs.load(std::memory_order_acquire) & ~box<T>::arena_bit) == 1;
+}
+
+/**
+ * Point b at a box of its own, copying the shared one if needed. Only the
+ * top level is copied: the elements of a container keep sharing theirs
+ * until they are modified in turn.
+ **/
+template <typename T>
+inline void unshare(box<T> *&b)
+{
+    if (!unique(b))
+    {
+        auto copy = make_box<T>(b->value);
+        release(b);
+        b = copy;
+    }
+}
+
+value borrow_string(const char *data, std::size_t size, bool escaped);
+
+template <typename Sink>
+class writer;
+
+template <typename Sink>
+class cbor_writer;
+
+} // namespace detail
+/**
+ * @endcond detail
+ **/
+
+/**
+ * @brief enumeration of the possible json value types
+ **/
+enum ValueType
+{
+    JSON_ARRAY,
+    JSON_BOOL,
+    JSON_NULL,
+    JSON_NUMBER,
+    JSON_OBJECT,
+    JSON_STRING,
+};
+
+/**
+ * @brief enumeration of the ways a json number can be stored
+ **/
+enum NumberType
+{
+    JSON_DOUBLE,
+    JSON_INT64,
+    JSON_UINT64,
+};
+
+/**
+ * @brief Represents any json data type.
+ *
+ * Null, bool and number are stored inline. String, array and object are
+ * held in a single reference-counted allocation which is shared between
+ * copies of the value.
+ *
+ * Copies are copy-on-write: the non-const get_array, get_object and
+ * get_string first give the value its own copy of shared storage. Copying
+ * is shallow, so changing one member of a large shared tree only copies
+ * the containers on the path to it. A reference they return is only good
+ * until the value is copied again.
+ *
+ * Thread safety: any number of threads may read one value through const
+ * references, and may copy it, at the same time. Only its non-const members
+ * modify a value, and no other thread may be using that same value object
+ * while they do. (A const get_string of a string borrowed with
+ * @ref parse_view decodes it once and publishes the copy atomically, so it
+ * too is safe to call concurrently.)
+ * Separate copies may be modified on separate threads, as copy-on-write
+ * keeps their shared storage intact. Reading through references touches no
+ * reference counts, so it scales better than copying under contention.
+ *
+ * Define JSON_SINGLE_THREADED before including json.hpp to use plain
+ * instead of atomic reference counts. Values sharing storage, copies
+ * included, must then stay on one thread.
+ **/
+class value
+{
+protected:
+    union
+    {
+        bool _bool;
+        number _number;
+        std::int64_t _int;
+        std::uint64_t _uint;
+        detail::box<array> *_array;
+        detail::box<object> *_object;
+        detail::box<string> *_string;
+        // A borrowed string: its characters in the input, or once a const
+        // read has decoded them, the tagged box holding the copy
+        mutable std::atomic<std::uintptr_t> _borrowed;
+    };
+    ValueType _type{ JSON_NULL };
+
+    // The NumberType of a number. Nonzero for a string borrowed from its
+    // input: the length of the referenced characters above the flag bits.
+    std::uint32_t _aux{ 0 };
+
+    static const std::uint32_t borrowed_bit = 1;
+    static const std::uint32_t escaped_bit = 2;
+    // The low bit of the input pointer. A decoded box is tagged with the
+    // opposite low bit, which tells the two apart.
+    static const std::uint32_t odd_bit = 4;
+    // Borrowed while parsing into a document, whose input goes away with it
+    static const std::uint32_t scoped_bit = 8;
+    static const unsigned aux_shift = 4;
+
+    friend value detail::borrow_string(const char *, std::size_t, bool);
+    template <typename Sink>
+    friend class detail::writer;
+    template <typename Sink>
+    friend class detail::cbor_writer;
+
+public:
+    /**
+     * Construct an empty value
+     **/
+    value()
+        : _number(0)
+    {
+    }
+
+    ////////////////////////////////////////// Array
+    /**
+     * Construct a value with an array (or std::vector<value>)
+     * @param x the array to store in the value
+     **/
+    value(array const &x)
+        : _array(detail::make_box<array>(x))
+        , _type(JSON_ARRAY)
+    {
+    }
+
+    /**
+     * Construct a value by moving in an array
+     * @param x the array to store in the value
+     **/
+    value(array &&x)
+        : _array(detail::make_box<array>(std::move(x)))
+        , _type(JSON_ARRAY)
+    {
+    }
+
+    /**
+     * Construct a value with an @ref arraylike object
+     * @param x the array to store in the value
+     **/
+    value(arraylike const &x)
+        : _array(detail::make_box<array>(x.to_json_array()))
+        , _type(JSON_ARRAY)
+    {
+    }
+
+    ////////////////////////////////////////// Bool
+    /**
+     * Construct a value with a bool
+     * @param x the bool to store in the value
+     **/
+    value(bool x)
+        : _bool(x)
+        , _type(JSON_BOOL)
+    {
+    }
+
+    ////////////////////////////////////////// Number
+    /**
+     * Construct a value with a floating-point value
+     * @param x The floating-point value to store as a number
+     **/
+    value(double x)
+        : _number(x)
+        , _type(JSON_NUMBER)
+    {
+    }
+
+    /**
+     * Construct a value with an integral value
+     * @param x The integral value to store as a number
+     **/
+    value(int x)
+        : _int(x)
+        , _type(JSON_NUMBER)
+        , _aux(JSON_INT64)
+    {
+    }
+
+    /**
+     * Construct a value with an integral value
+     * @param x The integral value to store as a number
+     **/
+    value(long x)
+        : _int(x)
+        , _type(JSON_NUMBER)
+        , _aux(JSON_INT64)
+    {
+    }
+
+    /**
+     * Construct a value with an integral value
+     * @param x The integral value to store as a number
+     **/
+    value(long long x)
+        : _int(x)
+        , _type(JSON_NUMBER)
+        , _aux(JSON_INT64)
+    {
+    }
+
+    /**
+     * Construct a value with an unsigned integral value
+     * @param x The integral value to store as a number
+     **/
+    value(unsigned x)
+        : value(static_cast<unsigned long long>(x))
+    {
+    }
+
+    /**
+     * Construct a value with an unsigned integral value
+     * @param x The integral value to store as a number
+     **/
+    value(unsigned long x)
+        : value(static_cast<unsigned long long>(x))
+    {
+    }
+
+    /**
+     * Construct a value with an unsigned integral value. Values which fit
+     * are stored as int64, so each integer has a single representation.
+     * @param x The integral value to store as a number
+     **/
+    value(unsigned long long x)
+        : _type(JSON_NUMBER)
+    {
+        if (x > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()))
+        {
+            _uint = x;
+            _aux = JSON_UINT64;
+        }
+        else
+        {
+            _int = static_cast<std::int64_t>(x);
+            _aux = JSON_INT64;
+        }
+    }
+
+    ////////////////////////////////////////// Object
+    /**
+     * Construct a value with a json object (or std::map<string, value>)
+     * @param x The object to store in the value
+     **/
+    value(object const &x)
+        : _object(detail::make_box<object>(x))
+        , _type(JSON_OBJECT)
+    {
+    }
+
+    /**
+     * Construct a value by moving in a json object
+     * @param x The object to store in the value
+     **/
+    value(object &&x)
+        : _object(detail::make_box<object>(std::move(x)))
+        , _type(JSON_OBJECT)
+    {
+    }
+
+    /**
+     * Construct a value with an @ref objectlike object
+     * @param x The object to store in the value
+     **/
+    value(objectlike const &x)
+        : _object(detail::make_box<object>(x.to_json_object()))
+        , _type(JSON_OBJECT)
+    {
+    }
+
+    ////////////////////////////////////////// String
+    /**
+     * Construct a value with a string
+     * @param x The string to store in the value
+     **/
+    value(string const &x)
+        : _string(detail::make_box<string>(x))
+        , _type(JSON_STRING)
+    {
+    }
+
+    /**
+     * Construct a value by moving in a string
+     * @param x The string to store in the value
+     **/
+    value(string &&x)
+        : _string(detail::make_box<string>(std::move(x)))
+        , _type(JSON_STRING)
+    {
+    }
+
+    /**
+     * Construct a value with a null-terminated C-string
+     * @param x The string to store in the value
+     **/
+    value(const char *const &x)
+        : _string(detail::make_box<string>(x))
+        , _type(JSON_STRING)
+    {
+    }
+
+    /**
+     * Construct a value with a @ref stringlike object
+     * @param x The string to store in the value
+     **/
+    value(stringlike const &x)
+        : _string(detail::make_box<string>(x.to_json_string()))
+        , _type(JSON_STRING)
+    {
+    }
+
+public:
+    ~value()
+    {
+        release();
+    }
+
+    /**
+     * Copy constructor
+     * @param v the value to copy
+     **/
+    value(value const &v)
+        : _type(v._type)
+    {
+        copy_payload(v);
+        retain();
+    }
+
+    /**
+     * Move constructor
+     * @param v the value to move from; it is left null
+     **/
+    value(value &&v) noexcept
+        : _type(v._type)
+    {
+        copy_payload(v);
+        v._type = JSON_NULL;
+    }
+
+    /**
+     * Copy assignment operator
+     * @param v the value to copy
+     * @return a reference to this object
+     **/
+    inline value &operator=(value const &v)
+    {
+        if (this != &v)
+        {
+            release();
+            _type = v._type;
+            copy_payload(v);
+            retain();
+        }
+        return *this;
+    }
+
+    /**
+     * Move assignment operator
+     * @param v the value to move from; it is left null
+     * @return a reference to this object
+     **/
+    inline value &operator=(value &&v) noexcept
+    {
+        if (this != &v)
+        {
+            release();
+            _type = v._type;
+            copy_payload(v);
+            v._type = JSON_NULL;
+        }
+        return *this;
+    }
+
+public:
+    /**
+     * @return the value represented in json string form
+     **/
+    inline string json() const;
+
+    /**
+     * @brief append the json string form of the value to a string
+     * @param out the string to append to
+     **/
+    inline void json(string &out) const;
+
+    /**
+     * @return the json @ref ValueType of the value
+     */
+    inline ValueType type() const
+    {
+        return _type;
+    }
+
+    /**
+     * @return true if the value represents an array
+     **/
+    inline bool is_array() const { return _type == JSON_ARRAY; }
+    array const &get_array() const { checked(JSON_ARRAY); return _array->value; }
+    array &get_array() { checked(JSON_ARRAY); detail::unshare(_array); return _array->value; }
+    explicit operator array &() { return get_array(); }
+
+    /**
+     * @return true if the value represents a bool
+     **/
+    inline bool is_bool() const { return _type == JSON_BOOL; }
+    bool const get_bool() const { checked(JSON_BOOL); return _bool; }
+    bool get_bool() { checked(JSON_BOOL); return _bool; }
+
+    /**
+     * @return true if the value is null
+     **/
+    inline bool is_null() const { return _type == JSON_NULL; }
+
+    /**
+     * @return true if the value represents a number
+     **/
+    inline bool is_number() const { return _type == JSON_NUMBER; }
+
+    /**
+     * Reading never changes the value: an integer keeps its exact storage,
+     * and is only rounded in the copy returned. Assign a number to change it.
+     * @return the number as a double
+     **/
+    number get_number() const
+    {
+        checked(JSON_NUMBER);
+        switch (_aux)
+        {
+        case JSON_INT64:
+            return static_cast<number>(_int);
+        case JSON_UINT64:
+            return static_cast<number>(_uint);
+        default:
+            return _number;
+        }
+    }
+
+    /**
+     * @return how the number is stored
+     **/
+    NumberType number_type() const
+    {
+        checked(JSON_NUMBER);
+        return static_cast<NumberType>(_aux);
+    }
+
+    /**
+     * @return the number as a signed 64-bit integer, exact if it was stored
+     * as one
+     **/
+    std::int64_t get_int64() const
+    {
+        checked(JSON_NUMBER);
+        switch (_aux)
+        {
+        case JSON_INT64:
+            return _int;
+        case JSON_UINT64:
+            return static_cast<std::int64_t>(_uint);
+        default:
+            return static_cast<std::int64_t>(_number);
+        }
+    }
+
+    /**
+     * @return the number as an unsigned 64-bit integer, exact if it was
+     * stored as a nonnegative integer
+     **/
+    std::uint64_t get_uint64() const
+    {
+        checked(JSON_NUMBER);
+        switch (_aux)
+        {
+        case JSON_INT64:
+            return static_cast<std::uint64_t>(_int);
+        case JSON_UINT64:
+            return _uint;
+        default:
+            return static_cast<std::uint64_t>(_number);
+        }
+    }
+
+    /**
+     * @return true if the value represents an object
+     **/
+    inline bool is_object() const { return _type == JSON_OBJECT; }
+    object const &get_object() const { checked(JSON_OBJECT); return _object->value; }
+    object &get_object() { checked(JSON_OBJECT); detail::unshare(_object); return _object->value; }
+
+    /**
+     * @return true if the value represents a string
+     **/
+    inline bool is_string() const { return _type == JSON_STRING; }
+    string const &get_string() const { checked(JSON_STRING); return string_box()->value; }
+    string &get_string() { checked(JSON_STRING); materialize(); detail::unshare(_string); return _string->value; }
+
+    /**
+     * Get the characters of a string without copying them. A string borrowed
+     * from its input is referenced in place unless it contains escapes.
+     * @return a reference to the string, valid as long as the value and,
+     * for borrowed strings, the input buffer
+     **/
+    string_ref get_string_ref() const
+    {
+        checked(JSON_STRING);
+        if (_aux & borrowed_bit && !(_aux & escaped_bit))
+            return string_ref(view(), _aux >> aux_shift);
+        return string_box()->value;
+    }
+
+    /**
+     * @return true if the value is a string which still refers to the buffer
+     * it was parsed from (see @ref parse_view)
+     **/
+    inline bool is_borrowed() const { return _type == JSON_STRING && _aux & borrowed_bit; }
+
+private:
+    value(const char *data, std::size_t size, bool escaped)
+        : _borrowed(reinterpret_cast<std::uintptr_t>(data))
+        , _type(JSON_STRING)
+        , _aux(static_cast<std::uint32_t>(size << aux_shift) | borrowed_bit | (escaped ? escaped_bit : 0) |
+               (reinterpret_cast<std::uintptr_t>(data) & 1 ? odd_bit : 0) | (detail::current_arena() ? scoped_bit : 0))
+    {
+    }
+
+    void checked(ValueType type) const
+    {
+        if (_type != type)
+            throw exception("invalid cast");
+    }
+
+    // The box a borrowed string word w refers to, or nullptr while it
+    // still refers to the input
+    detail::box<string> *decoded(std::uintptr_t w) const
+    {
+        if ((w & 1) == ((_aux & odd_bit) ? 1u : 0u))
+            return nullptr;
+        return reinterpret_cast<detail::box<string> *>(w & ~std::uintptr_t(1));
+    }
+
+    // The characters of a borrowed string in its input, if it has not been
+    // decoded yet
+    const char *view() const
+    {
+        auto w = _borrowed.load(std::memory_order_acquire);
+        if (auto b = decoded(w))
+            return b->value.data();
+        return reinterpret_cast<const char *>(w);
+    }
+
+    // The string a borrowed value's characters p in its input stand for
+    string decode(const char *p) const
+    {
+        string rv;
+        if (_aux & escaped_bit)
+            detail::unescape_into(rv, p, p + (_aux >> aux_shift));
+        else
+            rv.assign(p, _aux >> aux_shift);
+        return rv;
+    }
+
+    // The box holding a string. A borrowed string is decoded on first use,
+    // and of threads racing to decode it the first to publish its box wins.
+    detail::box<string> *string_box() const
+    {
+        if (!(_aux & borrowed_bit))
+            return _string;
+        auto w = _borrowed.load(std::memory_order_acquire);
+        if (auto b = decoded(w))
+            return b;
+        auto b = new detail::box<string>(decode(reinterpret_cast<const char *>(w)));
+        auto tagged = reinterpret_cast<std::uintptr_t>(b) | ((_aux & odd_bit) ? 0u : 1u);
+        if (_borrowed.compare_exchange_strong(w, tagged, std::memory_order_acq_rel, std::memory_order_acquire))
+            return b;
+        detail::release(b);
+        return decoded(w);
+    }
+
+    // Replace a borrowed string with an owned one, before modifying it
+    void materialize()
+    {
+        if (_aux & borrowed_bit)
+        {
+            _string = string_box();
+            _aux = 0;
+        }
+    }
+
+    void copy_payload(value const &v) noexcept
+    {
+        switch (v._type)
+        {
+        case JSON_ARRAY:
+            _array = v._array;
+            break;
+        case JSON_BOOL:
+            _bool = v._bool;
+            break;
+        case JSON_OBJECT:
+            _object = v._object;
+            break;
+        case JSON_NUMBER:
+            if (v._aux == JSON_INT64)
+                _int = v._int;
+            else if (v._aux == JSON_UINT64)
+                _uint = v._uint;
+            else
+                _number = v._number;
+            break;
+        case JSON_STRING:
+            if (v._aux & borrowed_bit)
+                new (&_borrowed) std::atomic<std::uintptr_t>(v._borrowed.load(std::memory_order_acquire));
+            else
+                _string = v._string;
+            break;
+        default:
+            break;
+        }
+        _aux = v._aux;
+    }
+
+    void retain()
+    {
+        switch (_type)
+        {
+        case JSON_ARRAY:
+            detail::retain(_array);
+            break;
+        case JSON_OBJECT:
+            detail::retain(_object);
+            break;
+        case JSON_STRING:
+            if (!_aux)
+                detail::retain(_string);
+            else if (_aux & scoped_bit)
+            {
+                // Take a copy of our own rather than refer to a document's input
+                auto w = _borrowed.load(std::memory_order_relaxed);
+                auto b = decoded(w);
+                _string = new detail::box<string>(b ? b->value : decode(reinterpret_cast<const char *>(w)));
+                _aux = 0;
+            }
+            else if (auto b = decoded(_borrowed.load(std::memory_order_relaxed)))
+                detail::retain(b);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void release() noexcept
+    {
+        switch (_type)
+        {
+        case JSON_ARRAY:
+            detail::release(_array);
+            break;
+        case JSON_OBJECT:
+            detail::release(_object);
+            break;
+        case JSON_STRING:
+            if (!_aux)
+                detail::release(_string);
+            else if (auto b = decoded(_borrowed.load(std::memory_order_relaxed)))
+                detail::release(b);
+            break;
+        default:
+            break;
+        }
+    }
+};
+
+/**
+ * @cond detail
+ **/
+namespace detail
+{
+
+/**
+ * Writes the json form of a value tree to a sink in a single pass.
+ **/
+template <typename Sink>
+class writer
+{
+private:
+    Sink &_sink;
+
+    void write_literal(const char *s)
+    {
+        _sink.append(s, std::strlen(s));
+    }
+
+public:
+    explicit writer(Sink &sink)
+        : _sink(sink)
+    {
+    }
+
+    void write(value const &v)
+    {
+        switch (v._type)
+        {
+        case JSON_ARRAY:
+            write(v._array->value);
+            break;
+        case JSON_BOOL:
+            write_literal(bool_branch[v._bool]);
+            break;
+        case JSON_NULL:
+            write_literal("null");
+            break;
+        case JSON_NUMBER:
+            if (v._aux == JSON_INT64)
+                write_int(v._int);
+            else if (v._aux == JSON_UINT64)
+                write_uint(v._uint);
+            else
+                write_double(v._number);
+            break;
+        case JSON_OBJECT:
+            write(v._object->value);
+            break;
+        case JSON_STRING:
+            if (v._aux & value::escaped_bit)
+                write_string(v.get_string());
+            else if (v._aux)
+                write_string(v.view(), v._aux >> value::aux_shift);
+            else
+                write_string(v._string->value);
+            break;
+        }
+    }
+
+    void write(array const &a)
+    {
+        _sink.put('[');
+        bool first = true;
+        for (auto const &i : a)
+        {
+            if (!first)
+                _sink.append(", ", 2);
+            first = false;
+            write(i);
+        }
+        _sink.put(']');
+    }
+
+    void write(object const &o)
+    {
+        _sink.put('{');
+        bool first = true;
+        for (auto const &i : o)
+        {
+            if (!first)
+                _sink.append(", ", 2);
+            first = false;
+            write_string(i.first);
+            _sink.append(": ", 2);
+            write(i.second);
+        }
+        _sink.put('}');
+    }
+
+    void write_string(string const &s)
+    {
+        write_string(s.data(), s.size());
+    }
+
+    void write_string(const char *data, std::size_t size)
+    {
+        _sink.put('"');
+        escape_into(_sink, data, size);
+        _sink.put('"');
+    }
+
+    void write_uint(std::uint64_t u)
+    {
+        char buf[20];
+        auto p = buf + sizeof(buf);
+        do
+        {
+            *--p = static_cast<char>('0' + u % 10);
+            u /= 10;
+        } while (u);
+        _sink.append(p, buf + sizeof(buf) - p);
+    }
+
+    void write_int(std::int64_t i)
+    {
+        if (i < 0)
+        {
+            _sink.put('-');
+            write_uint(0 - static_cast<std::uint64_t>(i));
+        }
+        else
+        {
+            write_uint(static_cast<std::uint64_t>(i));
+        }
+    }
+
+    void write_double(double d)
+    {
+        write_shortest(d);
+    }
+
+    /**
+     * Write a number that was a float, in the shortest text that reads
+     * back as the same float
+     **/
+    void write_float(float f)
+    {
+        write_shortest(f);
+    }
+
+private:
+    template <typename Float>
+    void write_shortest(Float d)
+    {
+        // Integers up to 2^53 are exact in a double and are written as such
+        if (d >= -9007199254740992.0 && d <= 9007199254740992.0)
+        {
+            auto i = static_cast<std::int64_t>(d);
+            if (static_cast<Float>(i) == d && (i != 0 || !std::signbit(d)))
+            {
+                write_int(i);
+                return;
+            }
+        }
+        // json has no NaN or infinity
+        if (!std::isfinite(d))
+        {
+            _sink.append("null", 4);
+            return;
+        }
+        char buf[32];
+        _sink.append(buf, format_shortest(buf, d) - buf);
+    }
+};
+
+} // namespace detail
+/**
+ * @endcond detail
+ **/
+
+/**
+ * @brief Counts of what a parse built, as reported to
+ * @ref instrumentation::on_parse
+ **/
+struct parse_stats
+{
+    std::size_t nulls{ 0 };
+    std::size_t bools{ 0 };
+    std::size_t numbers{ 0 };
+    std::size_t strings{ 0 };
+    std::size_t arrays{ 0 };
+    std::size_t objects{ 0 };
+
+    /**
+     * @brief estimated heap bytes held by the tree: boxes, container
+     * elements and string characters. Borrowed strings count nothing.
+     **/
+    std::size_t bytes{ 0 };
+
+    /**
+     * @brief the deepest nesting of arrays and objects
+     **/
+    std::size_t max_depth{ 0 };
+
+    /**
+     * @brief the length of the input, or 0 when parsing a stream
+     **/
+    std::size_t input_bytes{ 0 };
+
+    /**
+     * @return the number of values in the tree
+     **/
+    std::size_t nodes() const
+    {
+        return nulls + bools + numbers + strings + arrays + objects;
+    }
+};
+
+/**
+ * @brief Callbacks run after each parse and serialization
+ *
+ * The callbacks are only called, and parses only counted, when the
+ * library is compiled with JSON_INSTRUMENT set to 1. Otherwise none of
+ * it is compiled in. Set them up before parsing on other threads.
+ **/
+struct instrumentation
+{
+    /**
+     * @brief called after each successful @ref parse, @ref parse_view,
+     * @ref parse_file and @ref document_stream record, with the time it
+     * took in seconds
+     **/
+    std::function<void(parse_stats const &, double seconds)> on_parse;
+
+    /**
+     * @brief called after @ref value::json and writing a @ref value to
+     * an ostream, with the bytes written and the time it took in seconds
+     **/
+    std::function<void(std::size_t bytes, double seconds)> on_serialize;
+};
+
+/**
+ * @return the process-wide instrumentation callbacks
+ **/
+inline instrumentation &hooks()
+{
+    static instrumentation h;
+    return h;
+}
+
+/**
+ * @cond detail
+ **/
+namespace detail
+{
+
+#if JSON_INSTRUMENT
+inline double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+#endif
+
+template <typename Sink, typename T>
+void write_timed(Sink &sink, T const &v)
+{
+#if JSON_INSTRUMENT
+    if (hooks().on_serialize)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto before = sink.written();
+        writer<Sink>(sink).write(v);
+        hooks().on_serialize(sink.written() - before, seconds_since(start));
+        return;
+    }
+#endif
+    writer<Sink>(sink).write(v);
+}
+
+} // namespace detail
+/**
+ * @endcond detail
+ **/
+
+/**
+ * @brief Put a json @ref value to an ostream object as json
+ **/
+inline std::ostream &operator<<(std::ostream &o, value const &v)
+{
+    detail::stream_sink sink(o);
+    detail::write_timed(sink, v);
+    return o;
+}
+
+/**
+ * @brief Put a json @ref array to an output stream as json
+ **/
+inline std::ostream &operator<<(std::ostream &o, array const &v)
+{
+    detail::stream_sink sink(o);
+    detail::writer<detail::stream_sink>(sink).write(v);
+    return o;
+}
+
+/**
+ * @brief Put a json @ref object to an output stream as json
+ */
+inline std::ostream &operator<<(std::ostream &o, object const &v)
+{
+    detail::stream_sink sink(o);
+    detail::writer<detail::stream_sink>(sink).write(v);
+    return o;
+}
+
+inline string value::json() const
+{
+    string rv;
+    json(rv);
+    return rv;
+}
+
+inline void value::json(string &out) const
+{
+    detail::string_sink sink(out);
+    detail::write_timed(sink, *this);
+}
+
+/**
+ * @brief The deepest nesting of arrays and objects that parsing accepts
+ *
+ * Deeper input fails with an @ref exception instead of exhausting memory,
+ * and keeps values shallow enough to destroy and serialize on small
+ * stacks. The limit starts at JSON_MAX_DEPTH, 1024 unless defined
+ * otherwise, and can be changed at any time.
+ *
+ * @return the limit, shared by all threads
+ **/
+inline std::atomic<std::size_t> &max_depth()
+{
+    static std::atomic<std::size_t> limit{ JSON_MAX_DEPTH };
+    return limit;
+}
+
+/**
+ * @cond detail
+ **/
+namespace detail
+{
+
+inline bool is_whitespace(char c)
+{
+    return c == ' ' || c == '\r' || c == '\n' || c == '\t';
+}
+
+/*
+ * Scanning of contiguous input 32 (AVX2) or 16 (SSE2, NEON) bytes at a
+ * time, with a scalar loop for the tail and for other targets.
+ */
+
+/**
+ * @return the first character in [p, end) which is not whitespace
+ **/
+inline const char *skip_whitespace(const char *p, const char *end)
+{
+#if defined(__AVX2__)
+    for (; end - p >= 32; p += 32)
+    {
+        auto c = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+        auto ws = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\t'))));
+        auto mask = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(ws));
+        if (mask)
+            return p + trailing_zeros(mask);
+    }
+#elif defined(__SSE2__)
+    for (; end - p >= 16; p += 16)
+    {
+        auto c = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+        auto ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(c, _mm_set1_epi8('\n'))),
+            _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(c, _mm_set1_epi8('\t'))));
+        auto mask = ~static_cast<unsigned>(_mm_movemask_epi8(ws)) & 0xFFFF;
+        if (mask)
+            return p + trailing_zeros(mask);
+    }
+#elif defined(__ARM_NEON)
+    for (; end - p >= 16; p += 16)
+    {
+        auto c = vld1q_u8(reinterpret_cast<std::uint8_t const *>(p));
+        auto ws = vorrq_u8(
+            vorrq_u8(vceqq_u8(c, vdupq_n_u8(' ')), vceqq_u8(c, vdupq_n_u8('\n'))),
+            vorrq_u8(vceqq_u8(c, vdupq_n_u8('\r')), vceqq_u8(c, vdupq_n_u8('\t'))));
+        auto mask = ~neon_mask(ws);
+        if (mask)
+            return p + (trailing_zeros(mask) >> 2);
+    }
+#endif
+    while (p != end && is_whitespace(*p))
+        ++p;
+    return p;
+}
+
+/**
+ * @return the first '"' or '\\' in [p, end), or end
+ **/
+inline const char *find_quote_or_backslash(const char *p, const char *end)
+{
+#if defined(__AVX2__)
+    for (; end - p >= 32; p += 32)
+    {
+        auto c = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+        auto hit = _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\\')));
+        auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(hit));
+        if (mask)
+            return p + trailing_zeros(mask);
+    }
+#elif defined(__SSE2__)
+    for (; end - p >= 16; p += 16)
+    {
+        auto c = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+        auto hit = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('"')), _mm_cmpeq_epi8(c, _mm_set1_epi8('\\')));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        if (mask)
+            return p + trailing_zeros(mask);
+    }
+#elif defined(__ARM_NEON)
+    for (; end - p >= 16; p += 16)
+    {
+        auto c = vld1q_u8(reinterpret_cast<std::uint8_t const *>(p));
+        auto mask = neon_mask(vorrq_u8(vceqq_u8(c, vdupq_n_u8('"')), vceqq_u8(c, vdupq_n_u8('\\'))));
+        if (mask)
+            return p + (trailing_zeros(mask) >> 2);
+    }
+#endif
+    while (p != end && *p != '"' && *p != '\\')
+        ++p;
+    return p;
+}
+
+/**
+ * A decimal number split into parts: (negative ? -1 : 1) * mantissa * 10^exponent.
+ * At most 19 significant digits are kept in the mantissa; truncated is set
+ * when nonzero digits were dropped.
+ **/
+struct decimal
+{
+    std::uint64_t mantissa{ 0 };
+    std::int32_t exponent{ 0 };
+    bool negative{ false };
+    bool truncated{ false };
+    bool integer{ true };
+};
+
+inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool is_number_char(char c)
+{
+    return is_digit(c) || c == '-' || c == '.' || c == 'e' || c == 'E' || c == '+';
+}
+
+/**
+ * Split the json number in [p, end) into a decimal.
+ * @return false if the characters are not a well-formed json number
+ **/
+inline bool scan_decimal(const char *p, const char *end, decimal &d)
+{
+    static const int max_digits = 19;
+    int digits = 0;
+    std::int64_t exponent = 0;
+
+    if (p != end && *p == '-')
+    {
+        d.negative = true;
+        ++p;
+    }
+    if (p == end || !is_digit(*p))
+        return false;
+    if (*p == '0')
+    {
+        ++p;
+    }
+    else
+    {
+        for (; p != end && is_digit(*p); ++p)
+        {
+            if (digits < max_digits)
+            {
+                d.mantissa = d.mantissa * 10 + (*p - '0');
+                ++digits;
+            }
+            else
+            {
+                d.truncated |= *p != '0';
+                ++exponent;
+            }
+        }
+    }
+    if (p != end && *p == '.')
+    {
+        d.integer = false;
+        if (++p == end || !is_digit(*p))
+            return false;
+        for (; p != end && is_digit(*p); ++p)
+        {
+            if (digits < max_digits)
+            {
+                d.mantissa = d.mantissa * 10 + (*p - '0');
+                digits += d.mantissa != 0;
+                --exponent;
+            }
+            else
+            {
+                d.truncated |= *p != '0';
+            }
+        }
+    }
+    if (p != end && (*p == 'e' || *p == 'E'))
+    {
+        d.integer = false;
+        bool negative = false;
+        if (++p != end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+        if (p == end || !is_digit(*p))
+            return false;
+        std::int64_t e = 0;
+        for (; p != end && is_digit(*p); ++p)
+        {
+            if (e < 100000)
+                e = e * 10 + (*p - '0');
+        }
+        exponent += negative ? -e : e;
+    }
+    if (exponent < -100000)
+        exponent = -100000;
+    else if (exponent > 100000)
+        exponent = 100000;
+    d.exponent = static_cast<std::int32_t>(exponent);
+    return p == end;
+}
+
+inline const std::uint64_t *power_of_five_128()
+{
+    // 128-bit approximations of 5^q for q in [-342, 308], normalized so the
+    // top bit is set: rounded down for q >= 0 and up for q < 0.
+    static const std::uint64_t table[] = {
+        0xeef453d6923bd65a, 0x113faa2906a13b3f,
+        0x9558b4661b6565f8, 0x4ac7ca59a424c507,
+        0xbaaee17fa23ebf76, 0x5d79bcf00d2df649,
+        0xe95a99df8ace6f53, 0xf4d82c2c107973dc,
+        0x91d8a02bb6c10594, 0x79071b9b8a4be869,
+        0xb64ec836a47146f9, 0x9748e2826cdee284,
+        0xe3e27a444d8d98b7, 0xfd1b1b2308169b25,
+        0x8e6d8c6ab0787f72, 0xfe30f0f5e50e20f7,
+        0xb208ef855c969f4f, 0xbdbd2d335e51a935,
+        0xde8b2b66b3bc4723, 0xad2c788035e61382,
+        0x8b16fb203055ac76, 0x4c3bcb5021afcc31,
+        0xaddcb9e83c6b1793, 0xdf4abe242a1bbf3d,
+        0xd953e8624b85dd78, 0xd71d6dad34a2af0d,
+        0x87d4713d6f33aa6b, 0x8672648c40e5ad68,
+        0xa9c98d8ccb009506, 0x680efdaf511f18c2,
+        0xd43bf0effdc0ba48, 0x0212bd1b2566def2,
+        0x84a57695fe98746d, 0x014bb630f7604b57,
+        0xa5ced43b7e3e9188, 0x419ea3bd35385e2d,
+        0xcf42894a5dce35ea, 0x52064cac828675b9,
+        0x818995ce7aa0e1b2, 0x7343efebd1940993,
+        0xa1ebfb4219491a1f, 0x1014ebe6c5f90bf8,
+        0xca66fa129f9b60a6, 0xd41a26e077774ef6,
+        0xfd00b897478238d0, 0x8920b098955522b4,
+        0x9e20735e8cb16382, 0x55b46e5f5d5535b0,
+        0xc5a890362fddbc62, 0xeb2189f734aa831d,
+        0xf712b443bbd52b7b, 0xa5e9ec7501d523e4,
+        0x9a6bb0aa55653b2d, 0x47b233c92125366e,
+        0xc1069cd4eabe89f8, 0x999ec0bb696e840a,
+        0xf148440a256e2c76, 0xc00670ea43ca250d,
+        0x96cd2a865764dbca, 0x380406926a5e5728,
+        0xbc807527ed3e12bc, 0xc605083704f5ecf2,
+        0xeba09271e88d976b, 0xf7864a44c633682e,
+        0x93445b8731587ea3, 0x7ab3ee6afbe0211d,
+        0xb8157268fdae9e4c, 0x5960ea05bad82964,
+        0xe61acf033d1a45df, 0x6fb92487298e33bd,
+        0x8fd0c16206306bab, 0xa5d3b6d479f8e056,
+        0xb3c4f1ba87bc8696, 0x8f48a4899877186c,
+        0xe0b62e2929aba83c, 0x331acdabfe94de87,
+        0x8c71dcd9ba0b4925, 0x9ff0c08b7f1d0b14,
+        0xaf8e5410288e1b6f, 0x07ecf0ae5ee44dd9,
+        0xdb71e91432b1a24a, 0xc9e82cd9f69d6150,
+        0x892731ac9faf056e, 0xbe311c083a225cd2,
+        0xab70fe17c79ac6ca, 0x6dbd630a48aaf406,
+        0xd64d3d9db981787d, 0x092cbbccdad5b108,
+        0x85f0468293f0eb4e, 0x25bbf56008c58ea5,
+        0xa76c582338ed2621, 0xaf2af2b80af6f24e,
+        0xd1476e2c07286faa, 0x1af5af660db4aee1,
+        0x82cca4db847945ca, 0x50d98d9fc890ed4d,
+        0xa37fce126597973c, 0xe50ff107bab528a0,
+        0xcc5fc196fefd7d0c, 0x1e53ed49a96272c8,
+        0xff77b1fcbebcdc4f, 0x25e8e89c13bb0f7a,
+        0x9faacf3df73609b1, 0x77b191618c54e9ac,
+        0xc795830d75038c1d, 0xd59df5b9ef6a2417,
+        0xf97ae3d0d2446f25, 0x4b0573286b44ad1d,
+        0x9becce62836ac577, 0x4ee367f9430aec32,
+        0xc2e801fb244576d5, 0x229c41f793cda73f,
+        0xf3a20279ed56d48a, 0x6b43527578c1110f,
+        0x9845418c345644d6, 0x830a13896b78aaa9,
+        0xbe5691ef416bd60c, 0x23cc986bc656d553,
+        0xedec366b11c6cb8f, 0x2cbfbe86b7ec8aa8,
+        0x94b3a202eb1c3f39, 0x7bf7d71432f3d6a9,
+        0xb9e08a83a5e34f07, 0xdaf5ccd93fb0cc53,
+        0xe858ad248f5c22c9, 0xd1b3400f8f9cff68,
+        0x91376c36d99995be, 0x23100809b9c21fa1,
+        0xb58547448ffffb2d, 0xabd40a0c2832a78a,
+        0xe2e69915b3fff9f9, 0x16c90c8f323f516c,
+        0x8dd01fad907ffc3b, 0xae3da7d97f6792e3,
+        0xb1442798f49ffb4a, 0x99cd11cfdf41779c,
+        0xdd95317f31c7fa1d, 0x40405643d711d583,
+        0x8a7d3eef7f1cfc52, 0x482835ea666b2572,
+        0xad1c8eab5ee43b66, 0xda3243650005eecf,
+        0xd863b256369d4a40, 0x90bed43e40076a82,
+        0x873e4f75e2224e68, 0x5a7744a6e804a291,
+        0xa90de3535aaae202, 0x711515d0a205cb36,
+        0xd3515c2831559a83, 0x0d5a5b44ca873e03,
+        0x8412d9991ed58091, 0xe858790afe9486c2,
+        0xa5178fff668ae0b6, 0x626e974dbe39a872,
+        0xce5d73ff402d98e3, 0xfb0a3d212dc8128f,
+        0x80fa687f881c7f8e, 0x7ce66634bc9d0b99,
+        0xa139029f6a239f72, 0x1c1fffc1ebc44e80,
+        0xc987434744ac874e, 0xa327ffb266b56220,
+        0xfbe9141915d7a922, 0x4bf1ff9f0062baa8,
+        0x9d71ac8fada6c9b5, 0x6f773fc3603db4a9,
+        0xc4ce17b399107c22, 0xcb550fb4384d21d3,
+        0xf6019da07f549b2b, 0x7e2a53a146606a48,
+        0x99c102844f94e0fb, 0x2eda7444cbfc426d,
+        0xc0314325637a1939, 0xfa911155fefb5308,
+        0xf03d93eebc589f88, 0x793555ab7eba27ca,
+        0x96267c7535b763b5, 0x4bc1558b2f3458de,
+        0xbbb01b9283253ca2, 0x9eb1aaedfb016f16,
+        0xea9c227723ee8bcb, 0x465e15a979c1cadc,
+        0x92a1958a7675175f, 0x0bfacd89ec191ec9,
+        0xb749faed14125d36, 0xcef980ec671f667b,
+        0xe51c79a85916f484, 0x82b7e12780e7401a,
+        0x8f31cc0937ae58d2, 0xd1b2ecb8b0908810,
+        0xb2fe3f0b8599ef07, 0x861fa7e6dcb4aa15,
+        0xdfbdcece67006ac9, 0x67a791e093e1d49a,
+        0x8bd6a141006042bd, 0xe0c8bb2c5c6d24e0,
+        0xaecc49914078536d, 0x58fae9f773886e18,
+        0xda7f5bf590966848, 0xaf39a475506a899e,
+        0x888f99797a5e012d, 0x6d8406c952429603,
+        0xaab37fd7d8f58178, 0xc8e5087ba6d33b83,
+        0xd5605fcdcf32e1d6, 0xfb1e4a9a90880a64,
+        0x855c3be0a17fcd26, 0x5cf2eea09a55067f,
+        0xa6b34ad8c9dfc06f, 0xf42faa48c0ea481e,
+        0xd0601d8efc57b08b, 0xf13b94daf124da26,
+        0x823c12795db6ce57, 0x76c53d08d6b70858,
+        0xa2cb1717b52481ed, 0x54768c4b0c64ca6e,
+        0xcb7ddcdda26da268, 0xa9942f5dcf7dfd09,
+        0xfe5d54150b090b02, 0xd3f93b35435d7c4c,
+        0x9efa548d26e5a6e1, 0xc47bc5014a1a6daf,
+        0xc6b8e9b0709f109a, 0x359ab6419ca1091b,
+        0xf867241c8cc6d4c0, 0xc30163d203c94b62,
+        0x9b407691d7fc44f8, 0x79e0de63425dcf1d,
+        0xc21094364dfb5636, 0x985915fc12f542e4,
+        0xf294b943e17a2bc4, 0x3e6f5b7b17b2939d,
+        0x979cf3ca6cec5b5a, 0xa705992ceecf9c42,
+        0xbd8430bd08277231, 0x50c6ff782a838353,
+        0xece53cec4a314ebd, 0xa4f8bf5635246428,
+        0x940f4613ae5ed136, 0x871b7795e136be99,
+        0xb913179899f68584, 0x28e2557b59846e3f,
+        0xe757dd7ec07426e5, 0x331aeada2fe589cf,
+        0x9096ea6f3848984f, 0x3ff0d2c85def7621,
+        0xb4bca50b065abe63, 0x0fed077a756b53a9,
+        0xe1ebce4dc7f16dfb, 0xd3e8495912c62894,
+        0x8d3360f09cf6e4bd, 0x64712dd7abbbd95c,
+        0xb080392cc4349dec, 0xbd8d794d96aacfb3,
+        0xdca04777f541c567, 0xecf0d7a0fc5583a0,
+        0x89e42caaf9491b60, 0xf41686c49db57244,
+        0xac5d37d5b79b6239, 0x311c2875c522ced5,
+        0xd77485cb25823ac7, 0x7d633293366b828b,
+        0x86a8d39ef77164bc, 0xae5dff9c02033197,
+        0xa8530886b54dbdeb, 0xd9f57f830283fdfc,
+        0xd267caa862a12d66, 0xd072df63c324fd7b,
+        0x8380dea93da4bc60, 0x4247cb9e59f71e6d,
+        0xa46116538d0deb78, 0x52d9be85f074e608,
+        0xcd795be870516656, 0x67902e276c921f8b,
+        0x806bd9714632dff6, 0x00ba1cd8a3db53b6,
+        0xa086cfcd97bf97f3, 0x80e8a40eccd228a4,
+        0xc8a883c0fdaf7df0, 0x6122cd128006b2cd,
+        0xfad2a4b13d1b5d6c, 0x796b805720085f81,
+        0x9cc3a6eec6311a63, 0xcbe3303674053bb0,
+        0xc3f490aa77bd60fc, 0xbedbfc4411068a9c,
+        0xf4f1b4d515acb93b, 0xee92fb5515482d44,
+        0x991711052d8bf3c5, 0x751bdd152d4d1c4a,
+        0xbf5cd54678eef0b6, 0xd262d45a78a0635d,
+        0xef340a98172aace4, 0x86fb897116c87c34,
+        0x9580869f0e7aac0e, 0xd45d35e6ae3d4da0,
+        0xbae0a846d2195712, 0x8974836059cca109,
+        0xe998d258869facd7, 0x2bd1a438703fc94b,
+        0x91ff83775423cc06, 0x7b6306a34627ddcf,
+        0xb67f6455292cbf08, 0x1a3bc84c17b1d542,
+        0xe41f3d6a7377eeca, 0x20caba5f1d9e4a93,
+        0x8e938662882af53e, 0x547eb47b7282ee9c,
+        0xb23867fb2a35b28d, 0xe99e619a4f23aa43,
+        0xdec681f9f4c31f31, 0x6405fa00e2ec94d4,
+        0x8b3c113c38f9f37e, 0xde83bc408dd3dd04,
+        0xae0b158b4738705e, 0x9624ab50b148d445,
+        0xd98ddaee19068c76, 0x3badd624dd9b0957,
+        0x87f8a8d4cfa417c9, 0xe54ca5d70a80e5d6,
+        0xa9f6d30a038d1dbc, 0x5e9fcf4ccd211f4c,
+        0xd47487cc8470652b, 0x7647c3200069671f,
+        0x84c8d4dfd2c63f3b, 0x29ecd9f40041e073,
+        0xa5fb0a17c777cf09, 0xf468107100525890,
+        0xcf79cc9db955c2cc, 0x7182148d4066eeb4,
+        0x81ac1fe293d599bf, 0xc6f14cd848405530,
+        0xa21727db38cb002f, 0xb8ada00e5a506a7c,
+        0xca9cf1d206fdc03b, 0xa6d90811f0e4851c,
+        0xfd442e4688bd304a, 0x908f4a166d1da663,
+        0x9e4a9cec15763e2e, 0x9a598e4e043287fe,
+        0xc5dd44271ad3cdba, 0x40eff1e1853f29fd,
+        0xf7549530e188c128, 0xd12bee59e68ef47c,
+        0x9a94dd3e8cf578b9, 0x82bb74f8301958ce,
+        0xc13a148e3032d6e7, 0xe36a52363c1faf01,
+        0xf18899b1bc3f8ca1, 0xdc44e6c3cb279ac1,
+        0x96f5600f15a7b7e5, 0x29ab103a5ef8c0b9,
+        0xbcb2b812db11a5de, 0x7415d448f6b6f0e7,
+        0xebdf661791d60f56, 0x111b495b3464ad21,
+        0x936b9fcebb25c995, 0xcab10dd900beec34,
+        0xb84687c269ef3bfb, 0x3d5d514f40eea742,
+        0xe65829b3046b0afa, 0x0cb4a5a3112a5112,
+        0x8ff71a0fe2c2e6dc, 0x47f0e785eaba72ab,
+        0xb3f4e093db73a093, 0x59ed216765690f56,
+        0xe0f218b8d25088b8, 0x306869c13ec3532c,
+        0x8c974f7383725573, 0x1e414218c73a13fb,
+        0xafbd2350644eeacf, 0xe5d1929ef90898fa,
+        0xdbac6c247d62a583, 0xdf45f746b74abf39,
+        0x894bc396ce5da772, 0x6b8bba8c328eb783,
+        0xab9eb47c81f5114f, 0x066ea92f3f326564,
+        0xd686619ba27255a2, 0xc80a537b0efefebd,
+        0x8613fd0145877585, 0xbd06742ce95f5f36,
+        0xa798fc4196e952e7, 0x2c48113823b73704,
+        0xd17f3b51fca3a7a0, 0xf75a15862ca504c5,
+        0x82ef85133de648c4, 0x9a984d73dbe722fb,
+        0xa3ab66580d5fdaf5, 0xc13e60d0d2e0ebba,
+        0xcc963fee10b7d1b3, 0x318df905079926a8,
+        0xffbbcfe994e5c61f, 0xfdf17746497f7052,
+        0x9fd561f1fd0f9bd3, 0xfeb6ea8bedefa633,
+        0xc7caba6e7c5382c8, 0xfe64a52ee96b8fc0,
+        0xf9bd690a1b68637b, 0x3dfdce7aa3c673b0,
+        0x9c1661a651213e2d, 0x06bea10ca65c084e,
+        0xc31bfa0fe5698db8, 0x486e494fcff30a62,
+        0xf3e2f893dec3f126, 0x5a89dba3c3efccfa,
+        0x986ddb5c6b3a76b7, 0xf89629465a75e01c,
+        0xbe89523386091465, 0xf6bbb397f1135823,
+        0xee2ba6c0678b597f, 0x746aa07ded582e2c,
+        0x94db483840b717ef, 0xa8c2a44eb4571cdc,
+        0xba121a4650e4ddeb, 0x92f34d62616ce413,
+        0xe896a0d7e51e1566, 0x77b020baf9c81d17,
+        0x915e2486ef32cd60, 0x0ace1474dc1d122e,
+        0xb5b5ada8aaff80b8, 0x0d819992132456ba,
+        0xe3231912d5bf60e6, 0x10e1fff697ed6c69,
+        0x8df5efabc5979c8f, 0xca8d3ffa1ef463c1,
+        0xb1736b96b6fd83b3, 0xbd308ff8a6b17cb2,
+        0xddd0467c64bce4a0, 0xac7cb3f6d05ddbde,
+        0x8aa22c0dbef60ee4, 0x6bcdf07a423aa96b,
+        0xad4ab7112eb3929d, 0x86c16c98d2c953c6,
+        0xd89d64d57a607744, 0xe871c7bf077ba8b7,
+        0x87625f056c7c4a8b, 0x11471cd764ad4972,
+        0xa93af6c6c79b5d2d, 0xd598e40d3dd89bcf,
+        0xd389b47879823479, 0x4aff1d108d4ec2c3,
+        0x843610cb4bf160cb, 0xcedf722a585139ba,
+        0xa54394fe1eedb8fe, 0xc2974eb4ee658828,
+        0xce947a3da6a9273e, 0x733d226229feea32,
+        0x811ccc668829b887, 0x0806357d5a3f525f,
+        0xa163ff802a3426a8, 0xca07c2dcb0cf26f7,
+        0xc9bcff6034c13052, 0xfc89b393dd02f0b5,
+        0xfc2c3f3841f17c67, 0xbbac2078d443ace2,
+        0x9d9ba7832936edc0, 0xd54b944b84aa4c0d,
+        0xc5029163f384a931, 0x0a9e795e65d4df11,
+        0xf64335bcf065d37d, 0x4d4617b5ff4a16d5,
+        0x99ea0196163fa42e, 0x504bced1bf8e4e45,
+        0xc06481fb9bcf8d39, 0xe45ec2862f71e1d6,
+        0xf07da27a82c37088, 0x5d767327bb4e5a4c,
+        0x964e858c91ba2655, 0x3a6a07f8d510f86f,
+        0xbbe226efb628afea, 0x890489f70a55368b,
+        0xeadab0aba3b2dbe5, 0x2b45ac74ccea842e,
+        0x92c8ae6b464fc96f, 0x3b0b8bc90012929d,
+        0xb77ada0617e3bbcb, 0x09ce6ebb40173744,
+        0xe55990879ddcaabd, 0xcc420a6a101d0515,
+        0x8f57fa54c2a9eab6, 0x9fa946824a12232d,
+        0xb32df8e9f3546564, 0x47939822dc96abf9,
+        0xdff9772470297ebd, 0x59787e2b93bc56f7,
+        0x8bfbea76c619ef36, 0x57eb4edb3c55b65a,
+        0xaefae51477a06b03, 0xede622920b6b23f1,
+        0xdab99e59958885c4, 0xe95fab368e45eced,
+        0x88b402f7fd75539b, 0x11dbcb0218ebb414,
+        0xaae103b5fcd2a881, 0xd652bdc29f26a119,
+        0xd59944a37c0752a2, 0x4be76d3346f0495f,
+        0x857fcae62d8493a5, 0x6f70a4400c562ddb,
+        0xa6dfbd9fb8e5b88e, 0xcb4ccd500f6bb952,
+        0xd097ad07a71f26b2, 0x7e2000a41346a7a7,
+        0x825ecc24c873782f, 0x8ed400668c0c28c8,
+        0xa2f67f2dfa90563b, 0x728900802f0f32fa,
+        0xcbb41ef979346bca, 0x4f2b40a03ad2ffb9,
+        0xfea126b7d78186bc, 0xe2f610c84987bfa8,
+        0x9f24b832e6b0f436, 0x0dd9ca7d2df4d7c9,
+        0xc6ede63fa05d3143, 0x91503d1c79720dbb,
+        0xf8a95fcf88747d94, 0x75a44c6397ce912a,
+        0x9b69dbe1b548ce7c, 0xc986afbe3ee11aba,
+        0xc24452da229b021b, 0xfbe85badce996168,
+        0xf2d56790ab41c2a2, 0xfae27299423fb9c3,
+        0x97c560ba6b0919a5, 0xdccd879fc967d41a,
+        0xbdb6b8e905cb600f, 0x5400e987bbc1c920,
+        0xed246723473e3813, 0x290123e9aab23b68,
+        0x9436c0760c86e30b, 0xf9a0b6720aaf6521,
+        0xb94470938fa89bce, 0xf808e40e8d5b3e69,
+        0xe7958cb87392c2c2, 0xb60b1d1230b20e04,
+        0x90bd77f3483bb9b9, 0xb1c6f22b5e6f48c2,
+        0xb4ecd5f01a4aa828, 0x1e38aeb6360b1af3,
+        0xe2280b6c20dd5232, 0x25c6da63c38de1b0,
+        0x8d590723948a535f, 0x579c487e5a38ad0e,
+        0xb0af48ec79ace837, 0x2d835a9df0c6d851,
+        0xdcdb1b2798182244, 0xf8e431456cf88e65,
+        0x8a08f0f8bf0f156b, 0x1b8e9ecb641b58ff,
+        0xac8b2d36eed2dac5, 0xe272467e3d222f3f,
+        0xd7adf884aa879177, 0x5b0ed81dcc6abb0f,
+        0x86ccbb52ea94baea, 0x98e947129fc2b4e9,
+        0xa87fea27a539e9a5, 0x3f2398d747b36224,
+        0xd29fe4b18e88640e, 0x8eec7f0d19a03aad,
+        0x83a3eeeef9153e89, 0x1953cf68300424ac,
+        0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7,
+        0xcdb02555653131b6, 0x3792f412cb06794d,
+        0x808e17555f3ebf11, 0xe2bbd88bbee40bd0,
+        0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4,
+        0xc8de047564d20a8b, 0xf245825a5a445275,
+        0xfb158592be068d2e, 0xeed6e2f0f0d56712,
+        0x9ced737bb6c4183d, 0x55464dd69685606b,
+        0xc428d05aa4751e4c, 0xaa97e14c3c26b886,
+        0xf53304714d9265df, 0xd53dd99f4b3066a8,
+        0x993fe2c6d07b7fab, 0xe546a8038efe4029,
+        0xbf8fdb78849a5f96, 0xde98520472bdd033,
+        0xef73d256a5c0f77c, 0x963e66858f6d4440,
+        0x95a8637627989aad, 0xdde7001379a44aa8,
+        0xbb127c53b17ec159, 0x5560c018580d5d52,
+        0xe9d71b689dde71af, 0xaab8f01e6e10b4a6,
+        0x9226712162ab070d, 0xcab3961304ca70e8,
+        0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22,
+        0xe45c10c42a2b3b05, 0x8cb89a7db77c506a,
+        0x8eb98a7a9a5b04e3, 0x77f3608e92adb242,
+        0xb267ed1940f1c61c, 0x55f038b237591ed3,
+        0xdf01e85f912e37a3, 0x6b6c46dec52f6688,
+        0x8b61313bbabce2c6, 0x2323ac4b3b3da015,
+        0xae397d8aa96c1b77, 0xabec975e0a0d081a,
+        0xd9c7dced53c72255, 0x96e7bd358c904a21,
+        0x881cea14545c7575, 0x7e50d64177da2e54,
+        0xaa242499697392d2, 0xdde50bd1d5d0b9e9,
+        0xd4ad2dbfc3d07787, 0x955e4ec64b44e864,
+        0x84ec3c97da624ab4, 0xbd5af13bef0b113e,
+        0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e,
+        0xcfb11ead453994ba, 0x67de18eda5814af2,
+        0x81ceb32c4b43fcf4, 0x80eacf948770ced7,
+        0xa2425ff75e14fc31, 0xa1258379a94d028d,
+        0xcad2f7f5359a3b3e, 0x096ee45813a04330,
+        0xfd87b5f28300ca0d, 0x8bca9d6e188853fc,
+        0x9e74d1b791e07e48, 0x775ea264cf55347e,
+        0xc612062576589dda, 0x95364afe032a819e,
+        0xf79687aed3eec551, 0x3a83ddbd83f52205,
+        0x9abe14cd44753b52, 0xc4926a9672793543,
+        0xc16d9a0095928a27, 0x75b7053c0f178294,
+        0xf1c90080baf72cb1, 0x5324c68b12dd6339,
+        0x971da05074da7bee, 0xd3f6fc16ebca5e04,
+        0xbce5086492111aea, 0x88f4bb1ca6bcf585,
+        0xec1e4a7db69561a5, 0x2b31e9e3d06c32e6,
+        0x9392ee8e921d5d07, 0x3aff322e62439fd0,
+        0xb877aa3236a4b449, 0x09befeb9fad487c3,
+        0xe69594bec44de15b, 0x4c2ebe687989a9b4,
+        0x901d7cf73ab0acd9, 0x0f9d37014bf60a11,
+        0xb424dc35095cd80f, 0x538484c19ef38c95,
+        0xe12e13424bb40e13, 0x2865a5f206b06fba,
+        0x8cbccc096f5088cb, 0xf93f87b7442e45d4,
+        0xafebff0bcb24aafe, 0xf78f69a51539d749,
+        0xdbe6fecebdedd5be, 0xb573440e5a884d1c,
+        0x89705f4136b4a597, 0x31680a88f8953031,
+        0xabcc77118461cefc, 0xfdc20d2b36ba7c3e,
+        0xd6bf94d5e57a42bc, 0x3d32907604691b4d,
+        0x8637bd05af6c69b5, 0xa63f9a49c2c1b110,
+        0xa7c5ac471b478423, 0x0fcf80dc33721d54,
+        0xd1b71758e219652b, 0xd3c36113404ea4a9,
+        0x83126e978d4fdf3b, 0x645a1cac083126ea,
+        0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a4,
+        0xcccccccccccccccc, 0xcccccccccccccccd,
+        0x8000000000000000, 0x0000000000000000,
+        0xa000000000000000, 0x0000000000000000,
+        0xc800000000000000, 0x0000000000000000,
+        0xfa00000000000000, 0x0000000000000000,
+        0x9c40000000000000, 0x0000000000000000,
+        0xc350000000000000, 0x0000000000000000,
+        0xf424000000000000, 0x0000000000000000,
+        0x9896800000000000, 0x0000000000000000,
+        0xbebc200000000000, 0x0000000000000000,
+        0xee6b280000000000, 0x0000000000000000,
+        0x9502f90000000000, 0x0000000000000000,
+        0xba43b74000000000, 0x0000000000000000,
+        0xe8d4a51000000000, 0x0000000000000000,
+        0x9184e72a00000000, 0x0000000000000000,
+        0xb5e620f480000000, 0x0000000000000000,
+        0xe35fa931a0000000, 0x0000000000000000,
+        0x8e1bc9bf04000000, 0x0000000000000000,
+        0xb1a2bc2ec5000000, 0x0000000000000000,
+        0xde0b6b3a76400000, 0x0000000000000000,
+        0x8ac7230489e80000, 0x0000000000000000,
+        0xad78ebc5ac620000, 0x0000000000000000,
+        0xd8d726b7177a8000, 0x0000000000000000,
+        0x878678326eac9000, 0x0000000000000000,
+        0xa968163f0a57b400, 0x0000000000000000,
+        0xd3c21bcecceda100, 0x0000000000000000,
+        0x84595161401484a0, 0x0000000000000000,
+        0xa56fa5b99019a5c8, 0x0000000000000000,
+        0xcecb8f27f4200f3a, 0x0000000000000000,
+        0x813f3978f8940984, 0x4000000000000000,
+        0xa18f07d736b90be5, 0x5000000000000000,
+        0xc9f2c9cd04674ede, 0xa400000000000000,
+        0xfc6f7c4045812296, 0x4d00000000000000,
+        0x9dc5ada82b70b59d, 0xf020000000000000,
+        0xc5371912364ce305, 0x6c28000000000000,
+        0xf684df56c3e01bc6, 0xc732000000000000,
+        0x9a130b963a6c115c, 0x3c7f400000000000,
+        0xc097ce7bc90715b3, 0x4b9f100000000000,
+        0xf0bdc21abb48db20, 0x1e86d40000000000,
+        0x96769950b50d88f4, 0x1314448000000000,
+        0xbc143fa4e250eb31, 0x17d955a000000000,
+        0xeb194f8e1ae525fd, 0x5dcfab0800000000,
+        0x92efd1b8d0cf37be, 0x5aa1cae500000000,
+        0xb7abc627050305ad, 0xf14a3d9e40000000,
+        0xe596b7b0c643c719, 0x6d9ccd05d0000000,
+        0x8f7e32ce7bea5c6f, 0xe4820023a2000000,
+        0xb35dbf821ae4f38b, 0xdda2802c8a800000,
+        0xe0352f62a19e306e, 0xd50b2037ad200000,
+        0x8c213d9da502de45, 0x4526f422cc340000,
+        0xaf298d050e4395d6, 0x9670b12b7f410000,
+        0xdaf3f04651d47b4c, 0x3c0cdd765f114000,
+        0x88d8762bf324cd0f, 0xa5880a69fb6ac800,
+        0xab0e93b6efee0053, 0x8eea0d047a457a00,
+        0xd5d238a4abe98068, 0x72a4904598d6d880,
+        0x85a36366eb71f041, 0x47a6da2b7f864750,
+        0xa70c3c40a64e6c51, 0x999090b65f67d924,
+        0xd0cf4b50cfe20765, 0xfff4b4e3f741cf6d,
+        0x82818f1281ed449f, 0xbff8f10e7a8921a4,
+        0xa321f2d7226895c7, 0xaff72d52192b6a0d,
+        0xcbea6f8ceb02bb39, 0x9bf4f8a69f764490,
+        0xfee50b7025c36a08, 0x02f236d04753d5b4,
+        0x9f4f2726179a2245, 0x01d762422c946590,
+        0xc722f0ef9d80aad6, 0x424d3ad2b7b97ef5,
+        0xf8ebad2b84e0d58b, 0xd2e0898765a7deb2,
+        0x9b934c3b330c8577, 0x63cc55f49f88eb2f,
+        0xc2781f49ffcfa6d5, 0x3cbf6b71c76b25fb,
+        0xf316271c7fc3908a, 0x8bef464e3945ef7a,
+        0x97edd871cfda3a56, 0x97758bf0e3cbb5ac,
+        0xbde94e8e43d0c8ec, 0x3d52eeed1cbea317,
+        0xed63a231d4c4fb27, 0x4ca7aaa863ee4bdd,
+        0x945e455f24fb1cf8, 0x8fe8caa93e74ef6a,
+        0xb975d6b6ee39e436, 0xb3e2fd538e122b44,
+        0xe7d34c64a9c85d44, 0x60dbbca87196b616,
+        0x90e40fbeea1d3a4a, 0xbc8955e946fe31cd,
+        0xb51d13aea4a488dd, 0x6babab6398bdbe41,
+        0xe264589a4dcdab14, 0xc696963c7eed2dd1,
+        0x8d7eb76070a08aec, 0xfc1e1de5cf543ca2,
+        0xb0de65388cc8ada8, 0x3b25a55f43294bcb,
+        0xdd15fe86affad912, 0x49ef0eb713f39ebe,
+        0x8a2dbf142dfcc7ab, 0x6e3569326c784337,
+        0xacb92ed9397bf996, 0x49c2c37f07965404,
+        0xd7e77a8f87daf7fb, 0xdc33745ec97be906,
+        0x86f0ac99b4e8dafd, 0x69a028bb3ded71a3,
+        0xa8acd7c0222311bc, 0xc40832ea0d68ce0c,
+        0xd2d80db02aabd62b, 0xf50a3fa490c30190,
+        0x83c7088e1aab65db, 0x792667c6da79e0fa,
+        0xa4b8cab1a1563f52, 0x577001b891185938,
+        0xcde6fd5e09abcf26, 0xed4c0226b55e6f86,
+        0x80b05e5ac60b6178, 0x544f8158315b05b4,
+        0xa0dc75f1778e39d6, 0x696361ae3db1c721,
+        0xc913936dd571c84c, 0x03bc3a19cd1e38e9,
+        0xfb5878494ace3a5f, 0x04ab48a04065c723,
+        0x9d174b2dcec0e47b, 0x62eb0d64283f9c76,
+        0xc45d1df942711d9a, 0x3ba5d0bd324f8394,
+        0xf5746577930d6500, 0xca8f44ec7ee36479,
+        0x9968bf6abbe85f20, 0x7e998b13cf4e1ecb,
+        0xbfc2ef456ae276e8, 0x9e3fedd8c321a67e,
+        0xefb3ab16c59b14a2, 0xc5cfe94ef3ea101e,
+        0x95d04aee3b80ece5, 0xbba1f1d158724a12,
+        0xbb445da9ca61281f, 0x2a8a6e45ae8edc97,
+        0xea1575143cf97226, 0xf52d09d71a3293bd,
+        0x924d692ca61be758, 0x593c2626705f9c56,
+        0xb6e0c377cfa2e12e, 0x6f8b2fb00c77836c,
+        0xe498f455c38b997a, 0x0b6dfb9c0f956447,
+        0x8edf98b59a373fec, 0x4724bd4189bd5eac,
+        0xb2977ee300c50fe7, 0x58edec91ec2cb657,
+        0xdf3d5e9bc0f653e1, 0x2f2967b66737e3ed,
+        0x8b865b215899f46c, 0xbd79e0d20082ee74,
+        0xae67f1e9aec07187, 0xecd8590680a3aa11,
+        0xda01ee641a708de9, 0xe80e6f4820cc9495,
+        0x884134fe908658b2, 0x3109058d147fdcdd,
+        0xaa51823e34a7eede, 0xbd4b46f0599fd415,
+        0xd4e5e2cdc1d1ea96, 0x6c9e18ac7007c91a,
+        0x850fadc09923329e, 0x03e2cf6bc604ddb0,
+        0xa6539930bf6bff45, 0x84db8346b786151c,
+        0xcfe87f7cef46ff16, 0xe612641865679a63,
+        0x81f14fae158c5f6e, 0x4fcb7e8f3f60c07e,
+        0xa26da3999aef7749, 0xe3be5e330f38f09d,
+        0xcb090c8001ab551c, 0x5cadf5bfd3072cc5,
+        0xfdcb4fa002162a63, 0x73d9732fc7c8f7f6,
+        0x9e9f11c4014dda7e, 0x2867e7fddcdd9afa,
+        0xc646d63501a1511d, 0xb281e1fd541501b8,
+        0xf7d88bc24209a565, 0x1f225a7ca91a4226,
+        0x9ae757596946075f, 0x3375788de9b06958,
+        0xc1a12d2fc3978937, 0x0052d6b1641c83ae,
+        0xf209787bb47d6b84, 0xc0678c5dbd23a49a,
+        0x9745eb4d50ce6332, 0xf840b7ba963646e0,
+        0xbd176620a501fbff, 0xb650e5a93bc3d898,
+        0xec5d3fa8ce427aff, 0xa3e51f138ab4cebe,
+        0x93ba47c980e98cdf, 0xc66f336c36b10137,
+        0xb8a8d9bbe123f017, 0xb80b0047445d4184,
+        0xe6d3102ad96cec1d, 0xa60dc059157491e5,
+        0x9043ea1ac7e41392, 0x87c89837ad68db2f,
+        0xb454e4a179dd1877, 0x29babe4598c311fb,
+        0xe16a1dc9d8545e94, 0xf4296dd6fef3d67a,
+        0x8ce2529e2734bb1d, 0x1899e4a65f58660c,
+        0xb01ae745b101e9e4, 0x5ec05dcff72e7f8f,
+        0xdc21a1171d42645d, 0x76707543f4fa1f73,
+        0x899504ae72497eba, 0x6a06494a791c53a8,
+        0xabfa45da0edbde69, 0x0487db9d17636892,
+        0xd6f8d7509292d603, 0x45a9d2845d3c42b6,
+        0x865b86925b9bc5c2, 0x0b8a2392ba45a9b2,
+        0xa7f26836f282b732, 0x8e6cac7768d7141e,
+        0xd1ef0244af2364ff, 0x3207d795430cd926,
+        0x8335616aed761f1f, 0x7f44e6bd49e807b8,
+        0xa402b9c5a8d3a6e7, 0x5f16206c9c6209a6,
+        0xcd036837130890a1, 0x36dba887c37a8c0f,
+        0x802221226be55a64, 0xc2494954da2c9789,
+        0xa02aa96b06deb0fd, 0xf2db9baa10b7bd6c,
+        0xc83553c5c8965d3d, 0x6f92829494e5acc7,
+        0xfa42a8b73abbf48c, 0xcb772339ba1f17f9,
+        0x9c69a97284b578d7, 0xff2a760414536efb,
+        0xc38413cf25e2d70d, 0xfef5138519684aba,
+        0xf46518c2ef5b8cd1, 0x7eb258665fc25d69,
+        0x98bf2f79d5993802, 0xef2f773ffbd97a61,
+        0xbeeefb584aff8603, 0xaafb550ffacfd8fa,
+        0xeeaaba2e5dbf6784, 0x95ba2a53f983cf38,
+        0x952ab45cfa97a0b2, 0xdd945a747bf26183,
+        0xba756174393d88df, 0x94f971119aeef9e4,
+        0xe912b9d1478ceb17, 0x7a37cd5601aab85d,
+        0x91abb422ccb812ee, 0xac62e055c10ab33a,
+        0xb616a12b7fe617aa, 0x577b986b314d6009,
+        0xe39c49765fdf9d94, 0xed5a7e85fda0b80b,
+        0x8e41ade9fbebc27d, 0x14588f13be847307,
+        0xb1d219647ae6b31c, 0x596eb2d8ae258fc8,
+        0xde469fbd99a05fe3, 0x6fca5f8ed9aef3bb,
+        0x8aec23d680043bee, 0x25de7bb9480d5854,
+        0xada72ccc20054ae9, 0xaf561aa79a10ae6a,
+        0xd910f7ff28069da4, 0x1b2ba1518094da04,
+        0x87aa9aff79042286, 0x90fb44d2f05d0842,
+        0xa99541bf57452b28, 0x353a1607ac744a53,
+        0xd3fa922f2d1675f2, 0x42889b8997915ce8,
+        0x847c9b5d7c2e09b7, 0x69956135febada11,
+        0xa59bc234db398c25, 0x43fab9837e699095,
+        0xcf02b2c21207ef2e, 0x94f967e45e03f4bb,
+        0x8161afb94b44f57d, 0x1d1be0eebac278f5,
+        0xa1ba1ba79e1632dc, 0x6462d92a69731732,
+        0xca28a291859bbf93, 0x7d7b8f7503cfdcfe,
+        0xfcb2cb35e702af78, 0x5cda735244c3d43e,
+        0x9defbf01b061adab, 0x3a0888136afa64a7,
+        0xc56baec21c7a1916, 0x088aaa1845b8fdd0,
+        0xf6c69a72a3989f5b, 0x8aad549e57273d45,
+        0x9a3c2087a63f6399, 0x36ac54e2f678864b,
+        0xc0cb28a98fcf3c7f, 0x84576a1bb416a7dd,
+        0xf0fdf2d3f3c30b9f, 0x656d44a2a11c51d5,
+        0x969eb7c47859e743, 0x9f644ae5a4b1b325,
+        0xbc4665b596706114, 0x873d5d9f0dde1fee,
+        0xeb57ff22fc0c7959, 0xa90cb506d155a7ea,
+        0x9316ff75dd87cbd8, 0x09a7f12442d588f2,
+        0xb7dcbf5354e9bece, 0x0c11ed6d538aeb2f,
+        0xe5d3ef282a242e81, 0x8f1668c8a86da5fa,
+        0x8fa475791a569d10, 0xf96e017d694487bc,
+        0xb38d92d760ec4455, 0x37c981dcc395a9ac,
+        0xe070f78d3927556a, 0x85bbe253f47b1417,
+        0x8c469ab843b89562, 0x93956d7478ccec8e,
+        0xaf58416654a6babb, 0x387ac8d1970027b2,
+        0xdb2e51bfe9d0696a, 0x06997b05fcc0319e,
+        0x88fcf317f22241e2, 0x441fece3bdf81f03,
+        0xab3c2fddeeaad25a, 0xd527e81cad7626c3,
+        0xd60b3bd56a5586f1, 0x8a71e223d8d3b074,
+        0x85c7056562757456, 0xf6872d5667844e49,
+        0xa738c6bebb12d16c, 0xb428f8ac016561db,
+        0xd106f86e69d785c7, 0xe13336d701beba52,
+        0x82a45b450226b39c, 0xecc0024661173473,
+        0xa34d721642b06084, 0x27f002d7f95d0190,
+        0xcc20ce9bd35c78a5, 0x31ec038df7b441f4,
+        0xff290242c83396ce, 0x7e67047175a15271,
+        0x9f79a169bd203e41, 0x0f0062c6e984d386,
+        0xc75809c42c684dd1, 0x52c07b78a3e60868,
+        0xf92e0c3537826145, 0xa7709a56ccdf8a82,
+        0x9bbcc7a142b17ccb, 0x88a66076400bb691,
+        0xc2abf989935ddbfe, 0x6acff893d00ea435,
+        0xf356f7ebf83552fe, 0x0583f6b8c4124d43,
+        0x98165af37b2153de, 0xc3727a337a8b704a,
+        0xbe1bf1b059e9a8d6, 0x744f18c0592e4c5c,
+        0xeda2ee1c7064130c, 0x1162def06f79df73,
+        0x9485d4d1c63e8be7, 0x8addcb5645ac2ba8,
+        0xb9a74a0637ce2ee1, 0x6d953e2bd7173692,
+        0xe8111c87c5c1ba99, 0xc8fa8db6ccdd0437,
+        0x910ab1d4db9914a0, 0x1d9c9892400a22a2,
+        0xb54d5e4a127f59c8, 0x2503beb6d00cab4b,
+        0xe2a0b5dc971f303a, 0x2e44ae64840fd61d,
+        0x8da471a9de737e24, 0x5ceaecfed289e5d2,
+        0xb10d8e1456105dad, 0x7425a83e872c5f47,
+        0xdd50f1996b947518, 0xd12f124e28f77719,
+        0x8a5296ffe33cc92f, 0x82bd6b70d99aaa6f,
+        0xace73cbfdc0bfb7b, 0x636cc64d1001550b,
+        0xd8210befd30efa5a, 0x3c47f7e05401aa4e,
+        0x8714a775e3e95c78, 0x65acfaec34810a71,
+        0xa8d9d1535ce3b396, 0x7f1839a741a14d0d,
+        0xd31045a8341ca07c, 0x1ede48111209a050,
+        0x83ea2b892091e44d, 0x934aed0aab460432,
+        0xa4e4b66b68b65d60, 0xf81da84d5617853f,
+        0xce1de40642e3f4b9, 0x36251260ab9d668e,
+        0x80d2ae83e9ce78f3, 0xc1d72b7c6b426019,
+        0xa1075a24e4421730, 0xb24cf65b8612f81f,
+        0xc94930ae1d529cfc, 0xdee033f26797b627,
+        0xfb9b7cd9a4a7443c, 0x169840ef017da3b1,
+        0x9d412e0806e88aa5, 0x8e1f289560ee864e,
+        0xc491798a08a2ad4e, 0xf1a6f2bab92a27e2,
+        0xf5b5d7ec8acb58a2, 0xae10af696774b1db,
+        0x9991a6f3d6bf1765, 0xacca6da1e0a8ef29,
+        0xbff610b0cc6edd3f, 0x17fd090a58d32af3,
+        0xeff394dcff8a948e, 0xddfc4b4cef07f5b0,
+        0x95f83d0a1fb69cd9, 0x4abdaf101564f98e,
+        0xbb764c4ca7a4440f, 0x9d6d1ad41abe37f1,
+        0xea53df5fd18d5513, 0x84c86189216dc5ed,
+        0x92746b9be2f8552c, 0x32fd3cf5b4e49bb4,
+        0xb7118682dbb66a77, 0x3fbc8c33221dc2a1,
+        0xe4d5e82392a40515, 0x0fabaf3feaa5334a,
+        0x8f05b1163ba6832d, 0x29cb4d87f2a7400e,
+        0xb2c71d5bca9023f8, 0x743e20e9ef511012,
+        0xdf78e4b2bd342cf6, 0x914da9246b255416,
+        0x8bab8eefb6409c1a, 0x1ad089b6c2f7548e,
+        0xae9672aba3d0c320, 0xa184ac2473b529b1,
+        0xda3c0f568cc4f3e8, 0xc9e5d72d90a2741e,
+        0x8865899617fb1871, 0x7e2fa67c7a658892,
+        0xaa7eebfb9df9de8d, 0xddbb901b98feeab7,
+        0xd51ea6fa85785631, 0x552a74227f3ea565,
+        0x8533285c936b35de, 0xd53a88958f87275f,
+        0xa67ff273b8460356, 0x8a892abaf368f137,
+        0xd01fef10a657842c, 0x2d2b7569b0432d85,
+        0x8213f56a67f6b29b, 0x9c3b29620e29fc73,
+        0xa298f2c501f45f42, 0x8349f3ba91b47b8f,
+        0xcb3f2f7642717713, 0x241c70a936219a73,
+        0xfe0efb53d30dd4d7, 0xed238cd383aa0110,
+        0x9ec95d1463e8a506, 0xf4363804324a40aa,
+        0xc67bb4597ce2ce48, 0xb143c6053edcd0d5,
+        0xf81aa16fdc1b81da, 0xdd94b7868e94050a,
+        0x9b10a4e5e9913128, 0xca7cf2b4191c8326,
+        0xc1d4ce1f63f57d72, 0xfd1c2f611f63a3f0,
+        0xf24a01a73cf2dccf, 0xbc633b39673c8cec,
+        0x976e41088617ca01, 0xd5be0503e085d813,
+        0xbd49d14aa79dbc82, 0x4b2d8644d8a74e18,
+        0xec9c459d51852ba2, 0xddf8e7d60ed1219e,
+        0x93e1ab8252f33b45, 0xcabb90e5c942b503,
+        0xb8da1662e7b00a17, 0x3d6a751f3b936243,
+        0xe7109bfba19c0c9d, 0x0cc512670a783ad4,
+        0x906a617d450187e2, 0x27fb2b80668b24c5,
+        0xb484f9dc9641e9da, 0xb1f9f660802dedf6,
+        0xe1a63853bbd26451, 0x5e7873f8a0396973,
+        0x8d07e33455637eb2, 0xdb0b487b6423e1e8,
+        0xb049dc016abc5e5f, 0x91ce1a9a3d2cda62,
+        0xdc5c5301c56b75f7, 0x7641a140cc7810fb,
+        0x89b9b3e11b6329ba, 0xa9e904c87fcb0a9d,
+        0xac2820d9623bf429, 0x546345fa9fbdcd44,
+        0xd732290fbacaf133, 0xa97c177947ad4095,
+        0x867f59a9d4bed6c0, 0x49ed8eabcccc485d,
+        0xa81f301449ee8c70, 0x5c68f256bfff5a74,
+        0xd226fc195c6a2f8c, 0x73832eec6fff3111,
+        0x83585d8fd9c25db7, 0xc831fd53c5ff7eab,
+        0xa42e74f3d032f525, 0xba3e7ca8b77f5e55,
+        0xcd3a1230c43fb26f, 0x28ce1bd2e55f35eb,
+        0x80444b5e7aa7cf85, 0x7980d163cf5b81b3,
+        0xa0555e361951c366, 0xd7e105bcc332621f,
+        0xc86ab5c39fa63440, 0x8dd9472bf3fefaa7,
+        0xfa856334878fc150, 0xb14f98f6f0feb951,
+        0x9c935e00d4b9d8d2, 0x6ed1bf9a569f33d3,
+        0xc3b8358109e84f07, 0x0a862f80ec4700c8,
+        0xf4a642e14c6262c8, 0xcd27bb612758c0fa,
+        0x98e7e9cccfbd7dbd, 0x8038d51cb897789c,
+        0xbf21e44003acdd2c, 0xe0470a63e6bd56c3,
+        0xeeea5d5004981478, 0x1858ccfce06cac74,
+        0x95527a5202df0ccb, 0x0f37801e0c43ebc8,
+        0xbaa718e68396cffd, 0xd30560258f54e6ba,
+        0xe950df20247c83fd, 0x47c6b82ef32a2069,
+        0x91d28b7416cdd27e, 0x4cdc331d57fa5441,
+        0xb6472e511c81471d, 0xe0133fe4adf8e952,
+        0xe3d8f9e563a198e5, 0x58180fddd97723a6,
+        0x8e679c2f5e44ff8f, 0x570f09eaa7ea7648,
+    };
+    return table;
+}
+
+/**
+ * Eisel-Lemire conversion of mantissa * 10^exponent to the nearest double.
+ * @return false if the result cannot be decided cheaply, in which case the
+ * caller has to fall back to a slower exact conversion
+ **/
+inline bool eisel_lemire(std::uint64_t w, std::int32_t q, double &out)
+{
+    if (w == 0 || q < -342)
+    {
+        out = 0;
+        return true;
+    }
+    if (q > 308)
+    {
+        out = std::numeric_limits<double>::infinity();
+        return true;
+    }
+
+    int lz = leading_zeros(w);
+    w <<= lz;
+
+    auto const *power = power_of_five_128() + 2 * (q + 342);
+    std::uint64_t hi, lo;
+    multiply_128(w, power[0], hi, lo);
+    if ((hi & 0x1FF) == 0x1FF)
+    {
+        std::uint64_t hi2, lo2;
+        multiply_128(w, power[1], hi2, lo2);
+        lo += hi2;
+        if (hi2 > lo)
+            ++hi;
+        if (lo == 0xFFFFFFFFFFFFFFFF && (q < -27 || q > 55))
+            return false;
+    }
+
+    std::uint64_t upper = hi >> 63;
+    std::uint64_t mantissa = hi >> (upper + 9);
+    std::int64_t power2 = (((152170 + 65536) * static_cast<std::int64_t>(q)) >> 16) + 63 + upper - lz + 1023;
+
+    if (power2 <= 0)
+        return false;
+    if (lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1)
+    {
+        if ((mantissa << (upper + 9)) == hi)
+            mantissa &= ~std::uint64_t(1);
+    }
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (std::uint64_t(2) << 52))
+    {
+        mantissa = std::uint64_t(1) << 52;
+        ++power2;
+    }
+    mantissa &= ~(std::uint64_t(1) << 52);
+    if (power2 >= 0x7FF)
+    {
+        out = std::numeric_limits<double>::infinity();
+        return true;
+    }
+
+    std::uint64_t bits = mantissa | static_cast<std::uint64_t>(power2) << 52;
+    std::memcpy(&out, &bits, sizeof(out));
+    return true;
+}
+
+/**
+ * Convert the json number in [begin, end) to a double.
+ * @throw @ref exception if the characters are not a well-formed number
+ **/
+inline double to_double(const char *begin, const char *end)
+{
+    static const double powers_of_ten[] = { 
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    decimal d;
+    if (!scan_decimal(begin, end, d))
+        throw exception(string("bad number: ") + string(begin, end));
+
+    double rv;
+    if (d.exponent == 0 && !d.truncated)
+    {
+        // uint64 to double conversion rounds correctly
+        rv = static_cast<double>(d.mantissa);
+    }
+    else if (!d.truncated && d.mantissa <= (std::uint64_t(1) << 53) && d.exponent >= -22 && d.exponent <= 22)
+    {
+        // Clinger's fast path: both operands are exact, so is the result
+        rv = static_cast<double>(d.mantissa);
+        rv = d.exponent < 0 ? rv / powers_of_ten[-d.exponent] : rv * powers_of_ten[d.exponent];
+    }
+    else
+    {
+        double upper;
+        if (!eisel_lemire(d.mantissa, d.exponent, rv) || (d.truncated && (!eisel_lemire(d.mantissa + 1, d.exponent, upper) || upper != rv)))
+        {
+            std::istringstream io(string(begin, end));
+            io.imbue(std::locale::classic());
+            io >> rv;
+            return rv;
+        }
+    }
+    return d.negative ? -rv : rv;
+}
+
+/**
+ * Convert the json number in [begin, end) to a value. Integers that fit
+ * in 64 bits are read exactly, without a floating-point conversion.
+ * @throw @ref exception if the characters are not a well-formed number
+ **/
+inline value to_number(const char *begin, const char *end)
+{
+    auto p = begin;
+    bool negative = p != end && *p == '-';
+    if (negative)
+        ++p;
+    auto digits = p;
+    std::uint64_t u = 0;
+    for (; p != end && is_digit(*p); ++p)
+    {
+        unsigned d = *p - '0';
+        if (u > (std::numeric_limits<std::uint64_t>::max() - d) / 10)
+            return to_double(begin, end);
+        u = u * 10 + d;
+    }
+    if (p != end || p == digits || (*digits == '0' && p - digits > 1))
+        return to_double(begin, end);
+
+    if (!negative)
+        return static_cast<unsigned long long>(u);
+    if (u == 0)
+        return -0.0;
+    if (u <= std::uint64_t(1) << 63)
+        return static_cast<long long>(-static_cast<std::int64_t>(u - 1) - 1);
+    return to_double(begin, end);
+}
+
+template <typename T>
+class peek
+{
+private:
+    T v;
+
+public:
+    peek(T v)
+        : v(v)
+    {
+    }
+    T operator*() const
+    {
+        return v;
+    }
+};
+
+/**
+ * Iterates a contiguous buffer. Dereferencing at the end yields '\0'
+ * rather than reading past the buffer. When Borrow is set, strings are
+ * parsed as references into the buffer instead of copies.
+ **/
+template <bool Borrow>
+class buffer_iterator
+{
+private:
+    const char *_cur;
+    const char *_end;
+
+public:
+    buffer_iterator(const char *cur, const char *end)
+        : _cur(cur)
+        , _end(end)
+    {
+    }
+
+    buffer_iterator &operator++()
+    {
+        ++_cur;
+        return *this;
+    }
+
+    char operator*() const
+    {
+        return _cur != _end ? *_cur : '\0';
+    }
+
+    peek<char> operator+(int i) const
+    {
+        return _end - _cur > i ? _cur[i] : '\0';
+    }
+
+    bool operator!=(buffer_iterator const &other) const
+    {
+        return _cur != other._cur;
+    }
+
+    const char *ptr() const
+    {
+        return _cur;
+    }
+};
+
+/**
+ * Move cur to the last character of the whitespace run it is on. Only
+ * contiguous input can skip ahead; other iterators step through the run
+ * in the grammar loops.
+ **/
+template <typename Iterator>
+void skip_whitespace(Iterator &, Iterator const &)
+{
+}
+
+template <bool Borrow>
+void skip_whitespace(buffer_iterator<Borrow> &cur, buffer_iterator<Borrow> const &end)
+{
+    cur = buffer_iterator<Borrow>(skip_whitespace(cur.ptr(), end.ptr()) - 1, end.ptr());
+}
+
+template <typename Iterator>
+value parse_number(Iterator &cur, Iterator const &end)
+{
+    // Copy the characters out of non-contiguous input; numbers too long
+    // for the buffer are rare enough to spill into a string.
+    char buf[64];
+    std::size_t n = 0;
+    string overflow;
+    do
+    {
+        if (n == sizeof(buf))
+        {
+            overflow.append(buf, n);
+            n = 0;
+        }
+        buf[n++] = *cur;
+        if (!is_number_char(*(cur + 1)))
+        {
+            break;
+        }
+    } while (++cur != end);
+    if (overflow.empty())
+        return to_number(buf, buf + n);
+    overflow.append(buf, n);
+    return to_number(overflow.data(), overflow.data() + overflow.size());
+}
+
+template <bool Borrow>
+value parse_number(buffer_iterator<Borrow> &cur, buffer_iterator<Borrow> const &end)
+{
+    auto begin = cur.ptr(), last = begin;
+    while (last + 1 != end.ptr() && is_number_char(last[1]))
+        ++last;
+    cur = buffer_iterator<Borrow>(last, end.ptr());
+    return to_number(begin, last + 1);
+}
+
+/**
+ * A string as found by the scanner: the raw characters, escapes still in
+ * place when escaped is set.
+ **/
+struct string_token
+{
+    string_ref text;
+    bool escaped;
+};
+
+/**
+ * Scan a string from non-contiguous input, copying its raw characters into
+ * scratch.
+ **/
+template <typename Iterator>
+string_token scan_string(Iterator &cur, Iterator const &end, string &scratch)
+{
+    scratch.clear();
+    bool escaped = false;
+    for (bool esc = false; cur != end; ++cur)
+    {
+        if (*cur == '"' && !esc)
+            return string_token{ scratch, escaped };
+        if (static_cast<unsigned char>(*cur) < 0x20)
+            throw exception("bad string: unescaped control character");
+        esc = *cur == '\\' && !esc;
+        escaped |= esc;
+        scratch += *cur;
+    }
+    throw exception(string("bad string: ") + scratch);
+}
+
+/**
+ * Scan a string in place, jumping between quotes, backslashes and the
+ * control characters json requires to be escaped. A control character
+ * fails the scan where it is, so that an unterminated string ends at the
+ * end of its line rather than swallowing the lines after it.
+ **/
+template <bool Borrow>
+string_token scan_string(buffer_iterator<Borrow> &cur, buffer_iterator<Borrow> const &end, string &)
+{
+    auto begin = cur.ptr(), p = begin, last = end.ptr();
+    bool escaped = false;
+    for (;;)
+    {
+        p = find_escape(p, last);
+        if (p == last)
+            break;
+        if (*p == '"')
+        {
+            cur = buffer_iterator<Borrow>(p, last);
+            return string_token{ string_ref(begin, p - begin), escaped };
+        }
+        if (*p != '\\' || ++p == last || static_cast<unsigned char>(*p) < 0x20)
+        {
+            if (p == last)
+                break;
+            cur = buffer_iterator<Borrow>(p, last);
+            throw exception("bad string: unescaped control character");
+        }
+        escaped = true;
+        ++p;
+    }
+    cur = end;
+    throw exception(string("bad string: ") + string(begin, last));
+}
+
+/**
+ * @return the characters of a string token with its escapes decoded,
+ * using scratch for storage if needed
+ **/
+inline string_ref decode(string_token const &t, string &scratch)
+{
+    if (!t.escaped)
+        return t.text;
+    if (t.text.data() == scratch.data())
+    {
+        // Scanned into scratch: decode in place
+        auto last = unescape_to(&scratch[0], scratch.data(), scratch.data() + scratch.size());
+        scratch.resize(last - scratch.data());
+        return scratch;
+    }
+    scratch.clear();
+    unescape_into(scratch, t.text.begin(), t.text.end());
+    return scratch;
+}
+
+/**
+ * @return the character after the string whose opening quote precedes p
+ **/
+inline const char *skip_string(const char *p, const char *end)
+{
+    for (;;)
+    {
+        p = find_quote_or_backslash(p, end);
+        if (p == end || *p == '"')
+            return p == end ? end : p + 1;
+        p = p + 2 < end ? p + 2 : end;
+    }
+}
+
+/**
+ * @return the character after the well-formed json value starting at p,
+ * matching brackets without interpreting anything in between
+ **/
+inline const char *skip_value(const char *p, const char *end)
+{
+    if (p == end)
+        return p;
+    if (*p == '"')
+        return skip_string(p + 1, end);
+    if (*p != '[' && *p != '{')
+    {
+        while (p != end && *p != ',' && *p != ']' && *p != '}' && !is_whitespace(*p))
+            ++p;
+        return p;
+    }
+    std::size_t depth = 0;
+    while (p != end)
+    {
+        switch (*p++)
+        {
+        case '"':
+            p = skip_string(p, end);
+            break;
+        case '[':
+        case '{':
+            ++depth;
+            break;
+        case ']':
+        case '}':
+            if (--depth == 0)
+                return p;
+            break;
+        default:
+            break;
+        }
+    }
+    return p;
+}
+
+inline value borrow_string(const char *data, std::size_t size, bool escaped)
+{
+    return value(data, size, escaped);
+}
+
+/**
+ * Counts the values a @ref dom_builder adds, when JSON_INSTRUMENT is set.
+ * Otherwise every member is empty and compiles away.
+ **/
+class counter
+{
+#if JSON_INSTRUMENT
+private:
+    parse_stats _stats;
+    std::size_t _depth{ 0 };
+
+public:
+    void add(value const &v)
+    {
+        switch (v.type())
+        {
+        case JSON_NULL:
+            ++_stats.nulls;
+            break;
+        case JSON_BOOL:
+            ++_stats.bools;
+            break;
+        case JSON_NUMBER:
+            ++_stats.numbers;
+            break;
+        case JSON_STRING:
+            ++_stats.strings;
+            break;
+        case JSON_ARRAY:
+            ++_stats.arrays;
+            _stats.bytes += sizeof(box<array>) + v.get_array().capacity() * sizeof(value);
+            break;
+        case JSON_OBJECT:
+            ++_stats.objects;
+            _stats.bytes += sizeof(box<object>) + v.get_object().size() * sizeof(object::value_type);
+            break;
+        }
+    }
+
+    void add_string(std::size_t size)
+    {
+        _stats.bytes += sizeof(box<string>) + size;
+    }
+
+    void open()
+    {
+        if (++_depth > _stats.max_depth)
+            _stats.max_depth = _depth;
+    }
+
+    void close()
+    {
+        --_depth;
+    }
+
+    parse_stats const &stats() const
+    {
+        return _stats;
+    }
+
+    void reset()
+    {
+        _stats = parse_stats();
+        _depth = 0;
+    }
+#else
+public:
+    void add(value const &) {}
+    void add_string(std::size_t) {}
+    void open() {}
+    void close() {}
+    parse_stats stats() const { return parse_stats(); }
+    void reset() {}
+#endif
+};
+
+/**
+ * Parse event handler building a value tree. With Borrow set, strings
+ * refer to the input as for @ref parse_view.
+ **/
+template <bool Borrow>
+class dom_builder
+{
+private:
+    std::vector<value> _stack;
+    std::vector<string> _keys;
+    value _root;
+
+    // The innermost open container, if it is an array or an object
+    array *_array{ nullptr };
+    object *_object{ nullptr };
+
+    counter _counter;
+
+    void add(value &&v)
+    {
+        _counter.add(v);
+        if (_array)
+            _array->push_back(std::move(v));
+        else if (_object)
+            (*_object)[std::move(_keys.back())] = std::move(v);
+        else
+            _root = std::move(v);
+    }
+
+    void open(value &&container)
+    {
+        _counter.open();
+        _stack.push_back(std::move(container));
+        auto &top = _stack.back();
+        _array = top.is_array() ? &top.get_array() : nullptr;
+        _object = top.is_object() ? &top.get_object() : nullptr;
+    }
+
+    void close()
+    {
+        _counter.close();
+        value v = std::move(_stack.back());
+        _stack.pop_back();
+        _array = nullptr;
+        _object = nullptr;
+        if (!_stack.empty())
+        {
+            auto &top = _stack.back();
+            _array = top.is_array() ? &top.get_array() : nullptr;
+            _object = top.is_object() ? &top.get_object() : nullptr;
+        }
+        add(std::move(v));
+    }
+
+public:
+    void on_null() { add(value()); }
+    void on_bool(bool b) { add(b); }
+    void on_number(value &&n) { add(std::move(n)); }
+    void on_string(string_ref s)
+    {
+        _counter.add_string(s.size());
+        add(s.str());
+    }
+
+    void on_string_token(string_token const &t)
+    {
+        if (t.text.size() >> 28)
+        {
+            string s;
+            unescape_into(s, t.text.begin(), t.text.end());
+            _counter.add_string(s.size());
+            add(std::move(s));
+        }
+        else
+        {
+            add(borrow_string(t.text.data(), t.text.size(), t.escaped));
+        }
+    }
+
+    void on_key(string_ref k) { _keys.back().assign(k.data(), k.size()); }
+
+    void on_start_array() { open(array()); }
+    void on_end_array() { close(); }
+
+    void on_start_object()
+    {
+        _keys.emplace_back();
+        open(object());
+    }
+
+    void on_end_object()
+    {
+        _keys.pop_back();
+        close();
+    }
+
+    // Make room for n members of the container just started. Reserving
+    // buckets ahead of small objects only slows a hash map down.
+    void reserve(std::size_t n)
+    {
+        if (_array)
+            _array->reserve(n);
+#ifdef JSON_ORDERED_OBJECT
+        else if (_object)
+            _object->reserve(n);
+#endif
+    }
+
+    value &result() { return _root; }
+
+    // What the values added since the last reset hold
+    parse_stats stats() const { return _counter.stats(); }
+
+    // Forget a partially built tree after a failed parse, or start counting
+    // the next one
+    void reset()
+    {
+        _stack.clear();
+        _keys.clear();
+        _array = nullptr;
+        _object = nullptr;
+        _root = value();
+        _counter.reset();
+    }
+};
+
+template <typename Handler>
+void emit_string(Handler &handler, string_token const &t, string &scratch)
+{
+    handler.on_string(decode(t, scratch));
+}
+
+inline void emit_string(dom_builder<true> &handler, string_token const &t, string &)
+{
+    handler.on_string_token(t);
+}
+
+/**
+ * Tokenizer reporting the json grammar as events to a handler. Nesting
+ * is tracked on an explicit stack rather than by recursion, so deep input
+ * costs heap rather than call stack, and is refused past @ref max_depth.
+ * parse_value leaves cur on the last character it consumed.
+ **/
+template <typename Iterator, typename Handler>
+class tokenizer
+{
+private:
+    Iterator &cur;
+    Iterator const &end;
+    Handler &handler;
+    string scratch;
+    // Containers already open around the value, counted toward max_depth
+    std::size_t outer_depth;
+
+    // Move cur to the next character that is not whitespace, or to end
+    void advance()
+    {
+        while (++cur != end && is_whitespace(*cur))
+            skip_whitespace(cur, end);
+    }
+
+    // With cur on the opening quote, report the key and move past the colon
+    void parse_key()
+    {
+        if (*cur != '"')
+            throw exception("bad object");
+        handler.on_key(decode(scan_string(++cur, end, scratch), scratch));
+        advance();
+        if (*cur != ':')
+            throw exception("bad object");
+        ++cur;
+    }
+
+    void parse_scalar()
+    {
+        switch (*cur)
+        {
+        case '"':
+            emit_string(handler, scan_string(++cur, end, scratch), scratch);
+            return;
+        case '0' ... '9':
+        case '-':
+            handler.on_number(parse_number(cur, end));
+            return;
+        case 'n':
+            if (*++cur == 'u' && *++cur == 'l' && *++cur == 'l')
+                return handler.on_null();
+            throw exception("bad json: null");
+        case 't':
+            if (*++cur == 'r' && *++cur == 'u' && *++cur == 'e')
+                return handler.on_bool(true);
+            throw exception(string("bad json: ") + *cur);
+        case 'f':
+            if (*++cur == 'a' && *++cur == 'l' && *++cur == 's' && *++cur == 'e')
+                return handler.on_bool(false);
+            throw exception("bad json: false");
+        default:
+            throw exception("bad json");
+        }
+    }
+
+public:
+    tokenizer(Iterator &cur, Iterator const &end, Handler &handler, std::size_t outer_depth = 0)
+        : cur(cur)
+        , end(end)
+        , handler(handler)
+        , outer_depth(outer_depth)
+    {
+    }
+
+    void parse_value()
+    {
+        auto limit = max_depth().load(std::memory_order_relaxed);
+        limit = limit > outer_depth ? limit - outer_depth : 0;
+        std::vector<bool> open; // true for objects, innermost last
+        for (;;)
+        {
+            // cur is on the first character of a value, or whitespace
+            // before it
+            if (is_whitespace(*cur))
+                advance();
+            if (*cur == '[' || *cur == '{')
+            {
+                if (open.size() == limit)
+                    throw exception("maximum depth exceeded");
+                bool is_object = *cur == '{';
+                if (is_object)
+                    handler.on_start_object();
+                else
+                    handler.on_start_array();
+                advance();
+                if (*cur != (is_object ? '}' : ']'))
+                {
+                    open.push_back(is_object);
+                    if (is_object)
+                        parse_key();
+                    continue;
+                }
+                if (is_object)
+                    handler.on_end_object();
+                else
+                    handler.on_end_array();
+            }
+            else
+            {
+                parse_scalar();
+            }
+
+            // Close every container that ends after this value
+            for (;;)
+            {
+                if (open.empty())
+                    return;
+                advance();
+                bool is_object = open.back();
+                if (*cur == ',')
+                {
+                    if (is_object)
+                    {
+                        advance();
+                        parse_key();
+                    }
+                    else
+                    {
+                        ++cur;
+                    }
+                    break;
+                }
+                if (*cur != (is_object ? '}' : ']'))
+                    throw exception(is_object ? "bad object" : "bad array");
+                open.pop_back();
+                if (is_object)
+                    handler.on_end_object();
+                else
+                    handler.on_end_array();
+            }
+        }
+    }
+};
+
+/**
+ * Parse one json value from [cur, end), then check that only whitespace
+ * follows it.
+ **/
+template <typename Iterator, typename Handler>
+void parse_events(Iterator &cur, Iterator const &end, Handler &handler)
+{
+    tokenizer<Iterator, Handler>(cur, end, handler).parse_value();
+
+    while (++cur != end)
+    {
+        if (!is_whitespace(*cur))
+            throw exception(string("garbage at end of input: ") + *cur);
+    }
+}
+
+template <typename Iterator>
+struct borrows : std::false_type
+{
+};
+
+template <>
+struct borrows<buffer_iterator<true>> : std::true_type
+{
+};
+
+template <typename Iterator>
+std::size_t input_size(Iterator const &, Iterator const &)
+{
+    return 0;
+}
+
+template <bool Borrow>
+std::size_t input_size(buffer_iterator<Borrow> const &cur, buffer_iterator<Borrow> const &end)
+{
+    return static_cast<std::size_t>(end.ptr() - cur.ptr());
+}
+
+template <typename Iterator>
+value parse(Iterator &cur, Iterator const &end)
+{
+    dom_builder<borrows<Iterator>::value> builder;
+#if JSON_INSTRUMENT
+    if (hooks().on_parse)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto size = input_size(cur, end);
+        parse_events(cur, end, builder);
+        auto stats = builder.stats();
+        stats.input_bytes = size;
+        hooks().on_parse(stats, seconds_since(start));
+        return std::move(builder.result());
+    }
+#endif
+    parse_events(cur, end, builder);
+    return std::move(builder.result());
+}
+
+/**
+ * Iterates an input stream, pulling blocks from its streambuf into an
+ * internal buffer instead of reading one character at a time.
+ **/
+template <typename T>
+class iterator
+{
+private:
+    static const std::size_t block_size = 64 * 1024;
+
+    std::basic_istream<T> &istream;
+    std::vector<T> buffer;
+    std::size_t pos{ 0 };
+    std::size_t size{ 0 };
+
+    // Read the next block after the first keep characters of the buffer.
+    void fill(std::size_t keep)
+    {
+        auto n = istream.rdbuf()->sgetn(buffer.data() + keep, block_size - keep);
+        size = keep + static_cast<std::size_t>(n > 0 ? n : 0);
+        if (size == keep)
+            istream.setstate(std::ios::eofbit);
+    }
+
+public:
+    iterator(std::basic_istream<T> &is)
+        : istream(is)
+        , buffer(block_size)
+    {
+        if (istream.rdbuf())
+            fill(0);
+    }
+
+    iterator(iterator const &) = delete;
+    iterator &operator=(iterator const &) = delete;
+
+    iterator &operator++()
+    {
+        if (++pos >= size && size)
+        {
+            pos = 0;
+            fill(0);
+        }
+        return *this;
+    }
+
+    T operator*() const
+    {
+        return pos < size ? buffer[pos] : T();
+    }
+
+    peek<T> operator+(int)
+    {
+        // Assumes you are peeking at the next character
+        if (pos + 1 >= size && pos < size)
+        {
+            // Carry the current character over so tokens can span blocks
+            buffer[0] = buffer[pos];
+            pos = 0;
+            fill(1);
+        }
+        return pos + 1 < size ? buffer[pos + 1] : T();
+    };
+
+    bool operator!=(iterator const &) const
+    {
+        // Assumes you are checking against the end iterator
+        return pos < size;
+    }
+};
+
+template <bool Borrow>
+value parse_buffer(const char *data, std::size_t size)
+{
+    buffer_iterator<Borrow> i(data, data + size), e(data + size, data + size);
+    return parse(i, e);
+}
+
+} // namespace detail
+/**
+ * @endcond detail
+ **/
+
+/**
+ * @brief parse json into a @ref value
+ * @param s the well-formed json to parse
+ * @return the parsed json as a @ref value
+ * @throw @ref exception if parsing failed
+ **/
+inline value parse(string const &s)
+{
+    return detail::parse_buffer<false>(s.data(), s.size());
+}
+
+/**
+ * @brief parse json from a caller-owned buffer without copying strings
+ *
+ * Strings are kept as references into the buffer. Strings containing
+ * escapes are only unescaped and copied when first accessed through
+ * @ref value::get_string. Object keys are always copied.
+ *
+ * @param data the well-formed json to parse
+ * @param size the length of the json in bytes
+ * @return the parsed json as a @ref value
+ * @throw @ref exception if parsing failed
+ * @warning the buffer must outlive the returned value and every copy of
+ * its borrowed strings
+ **/
+inline value parse_view(const char *data, std::size_t size)
+{
+    return detail::parse_buffer<true>(data, size);
+}
+
+/**
+ * @brief parse json from a string without copying its strings
+ * @see parse_view(const char *, std::size_t)
+ **/
+inline value parse_view(string_ref s)
+{
+    return parse_view(s.data(), s.size());
+}
+
+/**
+ * @brief The read-only contents of a file, memory-mapped where the
+ * platform supports it and read into memory otherwise.
+ **/
+class mapped_file
+{
+private:
+    const char *_data{ "" };
+    std::size_t _size{ 0 };
+    bool _mapped{ false };
+    std::vector<char> _buffer;
+
+public:
+    /**
+     * @brief construct an empty file
+     **/
+    mapped_file() {}
+
+    /**
+     * @brief map a file into memory
+     * @param path the file to map
+     * @throw @ref exception if the file could not be opened or read
+     **/
+    explicit mapped_file(string const &path)
+    {
+#if JSON_HAS_MMAP
+        if (map(path))
+            return;
+#endif
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            throw exception("cannot open " + path);
+        try
+        {
+            _buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        catch (std::exception const &)
+        {
+            throw exception("cannot read " + path);
+        }
+        if (in.bad())
+            throw exception("cannot read " + path);
+        _data = _buffer.data();
+        _size = _buffer.size();
+    }
+
+    mapped_file(mapped_file const &) = delete;
+    mapped_file &operator=(mapped_file const &) = delete;
+
+    mapped_file(mapped_file &&other) noexcept
+    {
+        swap(other);
+    }
+
+    mapped_file &operator=(mapped_file &&other) noexcept
+    {
+        mapped_file(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~mapped_file()
+    {
+#if JSON_HAS_MMAP
+        if (_mapped)
+            ::munmap(const_cast<char *>(_data), _size);
+#endif
+    }
+
+private:
+#if JSON_HAS_MMAP
+    // Map a regular file; anything else is left to the read fallback.
+    bool map(string const &path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw exception("cannot open " + path);
+        struct stat st;
+        bool regular = ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+        if (regular && st.st_size > 0)
+        {
+            auto size = static_cast<std::size_t>(st.st_size);
+            void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED)
+            {
+                ::madvise(p, size, MADV_SEQUENTIAL);
+                _data = static_cast<const char *>(p);
+                _size = size;
+                _mapped = true;
+            }
+        }
+        ::close(fd);
+        return _mapped || (regular && st.st_size == 0);
+    }
+#endif
+
+public:
+    void swap(mapped_file &other) noexcept
+    {
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+        std::swap(_mapped, other._mapped);
+        _buffer.swap(other._buffer);
+    }
+
+    /**
+     * @return the contents of the file
+     **/
+    const char *data() const { return _data; }
+
+    /**
+     * @return the size of the file in bytes
+     **/
+    std::size_t size() const { return _size; }
+};
+
+/**
+ * @brief parse json from a file, memory-mapping it where supported
+ * @param path the file containing the json to parse
+ * @return the parsed json as a @ref value
+ * @throw @ref exception if the file could not be read or parsing failed
+ **/
+inline value parse_file(string const &path)
+{
+    mapped_file file(path);
+    return detail::parse_buffer<false>(file.data(), file.size());
+}
+
+/**
+ * @brief parse json from an input stream
+ * @param istream the input stream from which to parse json
+ * @return the parsed json as a @ref value
+ * @throw @ref exception if parsing failed
+ **/
+template <typename T>
+value parse(std::basic_istream<T> &istream)
+{
+    detail::iterator<T> i(istream);
+    detail::iterator<T> &e = i;
+    return detail::parse(i, e);
+}
+
+/**
+ * @cond detail
+ **/
+namespace detail
+{
+
+/**
+ * Parse event handler writing into an existing value tree. Arrays,
+ * objects and strings already in the tree are overwritten in place, so
+ * input shaped like the previous contents reuses their storage.
+ **/
+class reusing_builder
+{
+private:
+    struct frame
+    {
+        value *self;
+        array *elements;
+        object *members;
+        // Elements written so far, or members kept: for ordered objects
+        // the members before this position, otherwise where this object's
+        // entries of _touched start
+        std::size_t count;
+    };
+
+    value &_root;
+    std::vector<frame> _stack;
+    // The member the next value of the innermost object goes to
+    value *_member{ nullptr };
+    string _key;
+    // Members written to in each open unordered object
+    std::vector<std::unordered_map<string, value>::value_type const *> _touched;
+
+    counter _counter;
+
+    // The value the next event writes to
+    value &next()
+    {
+        if (_stack.empty())
+            return _root;
+        auto &top = _stack.back();
+        if (top.members)
+            return *_member;
+        auto &elements = *top.elements;
+        if (top.count == elements.size())
+            elements.emplace_back();
+        return elements[top.count++];
+    }
+
+    void set_member(ordered_object &members, std::size_t &count, string_ref k)
+    {
+        auto it = members.begin() + count;
+        if (it == members.end() || it->first != k)
+        {
+            it = members.find(k);
+            // A member out of order, or a new one, ends the prefix shared
+            // with the old contents
+            if (it - members.begin() >= static_cast<std::ptrdiff_t>(count))
+            {
+                members.erase(members.begin() + count, members.end());
+                it = members.emplace(k, value()).first;
+            }
+        }
+        if (it - members.begin() == static_cast<std::ptrdiff_t>(count))
+            ++count;
+        _member = &it->second;
+    }
+
+    void set_member(std::unordered_map<string, value> &members, std::size_t &, string_ref k)
+    {
+        _key.assign(k.data(), k.size());
+        auto it = members.find(_key);
+        if (it == members.end())
+            it = members.emplace(_key, value()).first;
+        _touched.push_back(&*it);
+        _member = &it->second;
+    }
+
+    void end_members(ordered_object &members, std::size_t count)
+    {
+        members.erase(members.begin() + count, members.end());
+    }
+
+    // Remove the members the input did not mention
+    void end_members(std::unordered_map<string, value> &members, std::size_t begin)
+    {
+        auto first = _touched.begin() + begin;
+        std::sort(first, _touched.end());
+        auto last = std::unique(first, _touched.end());
+        if (static_cast<std::size_t>(last - first) != members.size())
+        {
+            for (auto it = members.begin(); it != members.end();)
+            {
+                if (std::binary_search(first, last, &*it))
+                    ++it;
+                else
+                    it = members.erase(it);
+            }
+        }
+        _touched.resize(begin);
+    }
+
+    void set(value &target, value &&v)
+    {
+        target = std::move(v);
+        _counter.add(target);
+    }
+
+    void close()
+    {
+        _counter.close();
+        _counter.add(*_stack.back().self);
+        _stack.pop_back();
+    }
+
+public:
+    explicit reusing_builder(value &root)
+        : _root(root)
+    {
+        // Room for typical nesting and object sizes in one allocation each
+        _stack.reserve(16);
+#ifndef JSON_ORDERED_OBJECT
+        _touched.reserve(64);
+#endif
+    }
+
+    void on_null() { set(next(), value()); }
+    void on_bool(bool b) { set(next(), b); }
+    void on_number(value &&n) { set(next(), std::move(n)); }
+
+    void on_string(string_ref s)
+    {
+        auto &target = next();
+        _counter.add_string(s.size());
+        if (target.is_string())
+            target.get_string().assign(s.data(), s.size());
+        else
+            target = s.str();
+        _counter.add(target);
+    }
+
+    void on_key(string_ref k)
+    {
+        auto &top = _stack.back();
+        set_member(*top.members, top.count, k);
+    }
+
+    void on_start_array()
+    {
+        auto &target = next();
+        if (!target.is_array())
+            target = array();
+        _counter.open();
+        _stack.push_back(frame{ &target, &target.get_array(), nullptr, 0 });
+    }
+
+    void on_end_array()
+    {
+        auto &top = _stack.back();
+        top.elements->erase(top.elements->begin() + top.count, top.elements->end());
+        close();
+    }
+
+    void on_start_object()
+    {
+        auto &target = next();
+        if (!target.is_object())
+            target = object();
+        _counter.open();
+#ifdef JSON_ORDERED_OBJECT
+        _stack.push_back(frame{ &target, nullptr, &target.get_object(), 0 });
+#else
+        _stack.push_back(frame{ &target, nullptr, &target.get_object(), _touched.size() });
+#endif
+    }
+
+    void on_end_object()
+    {
+        auto &top = _stack.back();
+        end_members(*top.members, top.count);
+        close();
+    }
+
+    parse_stats stats() const { return _counter.stats(); }
+};
+
+template <typename Iterator>
+void parse_into(value &target, Iterator &cur, Iterator const &end)
+{
+    reusing_builder builder(target);
+    try
+    {
+#if JSON_INSTRUMENT
+        if (hooks().on_parse)
+        {
+            auto start = std::chrono::steady_clock::now();
+            auto size = input_size(cur, end);
+            parse_events(cur, end, builder);
+            auto stats = builder.stats();
+            stats.input_bytes = size;
+            hooks().on_parse(stats, seconds_since(start));
+            return;
+        }
+#endif
+        parse_events(cur, end, builder);
+    }
+    catch (...)
+    {
+        target = value();
+        throw;
+    }
+}
+
+} // namespace detail
+/**
+ * @endcond detail
+ **/
+
+/**
+ * @brief parse json into an existing @ref value, reusing its storage
+ *
+ * The result is the same as assigning @ref parse(s) to target, but the
+ * arrays, objects and strings target already holds are overwritten in
+ * place wherever the new json has a container or string of the same
+ * kind at the same position. Parsing a stream of similarly shaped
+ * messages into one value then allocates little beyond the first
+ * message. Storage target shares with other values is copied first, so
+ * those values are not affected.
+ *
+ * @param target the value to overwrite
+ * @param s the well-formed json to parse
+ * @throw @ref exception if parsing failed; target is then null
+ **/
+inline void parse_into(value &target, string const &s)
+{
+    detail::buffer_iterator<false> i(s.data(), s.data() + s.size()), e(s.data() + s.size(), s.data() + s.size());
+    detail::parse_into(target, i, e);
+}
+
+/**
+ * @brief parse json from an input stream into an existing @ref value,
+ * reusing its storage as @ref parse_into(value &, string const &) does
+ * @param target the value to overwrite
+ * @param istream the input stream from which to parse json
+ * @throw @ref exception if parsing failed; target is then null
+ **/
+template <typename T>
+void parse_into(value &target, std::basic_istream<T> &istream)
+{
+    detail::iterator<T> i(istream);
+    detail::iterator<T> &e = i;
+    detail::parse_into(target, i, e);
+}
+
+/**
+ * @cond detail
+ **/
+namespace detail
+{
+
+/**
+ * Split the members of the top-level container whose first character
+ * follows p into runs of at least chunk_size bytes, cutting only at
+ * commas between members.
+ * @return the end of the last run, on the closing bracket, or end if the
+ * container is not closed
+ **/
+inline const char *split_members(const char *p, const char *end, std::size_t chunk_size, std::vector<string_ref> &chunks)
+{
+    auto begin = p;
+    std::size_t depth = 0;
+    while (p != end)
+    {
+        switch (*p)
+        {
+        case '"':
+            p = skip_string(p + 1, end);
+            continue;
+        case '[':
+        case '{':
+            ++depth;
+            break;
+        case ']':
+        case '}':
+            if (depth-- == 0)
+            {
+                chunks.push_back(string_ref(begin, p - begin));
+                return p;
+            }
+            break;
+        case ',':
+            if (depth == 0 && std::size_t(p - begin) >= chunk_size)
+            {
+                chunks.push_back(string_ref(begin, p - begin));
+                begin = p + 1;
+            }
+            break;
+        default:
+            break;
+        }
+        ++p;
+    }
+    return end;
+}
+
+/**
+ * Parse a run of comma-separated members, as split by
+ * @ref split_members, into values and, for objects, keys.
+ **/
+class member_parser
+{
+private:
+    dom_builder<false> _builder;
+    string _scratch;
+
+    template <typename Iterator>
+    value parse_value(Iterator &cur, Iterator const &end)
+    {
+        // Members sit one level inside the top-level container
+        tokenizer<Iterator, dom_builder<false>>(cur, end, _builder, 1).parse_value();
+        return std::move(_builder.result());
+    }
+
+public:
+    void parse(string_ref chunk, bool keyed, std::vector<value> &values, std::vector<string> &keys)
+    {
+        auto p = chunk.begin(), last = chunk.end();
+        for (;;)
+        {
+            p = skip_whitespace(p, last);
+            if (keyed)
+            {
+                if (p == last || *p != '"')
+                    throw exception("bad object");
+                buffer_iterator<false> cur(p + 1, last), e(last, last);
+                keys.push_back(decode(scan_string(cur, e, _scratch), _scratch).str());
+                p = skip_whitespace(cur.ptr() + 1, last);
+                if (p == last || *p != ':')
+                    throw exception("bad object");
+                ++p;
+            }
+            buffer_iterator<false> cur(p, last), e(last, last);
+            values.push_back(parse_value(cur, e));
+            p = skip_whitespace(cur.ptr() + 1, last);
+            if (p == last)
+                return;
+            if (*p++ != ',')
+                throw exception("bad json");
+        }
+    }
+};
+
+/**
+ * The members parsed from one chunk of a container
+ **/
+struct parsed_chunk
+{
+    std::vector<value> values;
+    std::vector<string> keys;
+};
+
+/**
+ * Parse the chunks of a container on a pool of threads, each claiming the
+ * next unparsed chunk when it finishes one.
+ * @return false if any chunk failed to parse
+ **/
+inline bool parse_chunks(std::vector<string_ref> const &chunks, bool keyed, unsigned threads, std::vector<parsed_chunk> &out)
+{
+    out.resize(chunks.size());
+    std::atomic<std::size_t> next{ 0 };
+    std::atomic<bool> failed{ false };
+    auto work = [&]() {
+        member_parser parser;
+        for (std::size_t i; !failed && (i = next++) < chunks.size();)
+        {
+            try
+            {
+                parser.parse(chunks[i], keyed, out[i].values, out[i].keys);
+            }
+            catch (...)
+            {
+                failed = true;
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i)
+    {
+        try
+        {
+            pool.emplace_back(work);
+        }
+        catch (std::system_error const &)
+        {
+            // Make do with the threads already started
+            break;
+        }
+    }
+    work();
+    for (auto &t : pool)
+        t.join();
+    return !failed;
+}
+
+} // namespace detail
+/**
+ * @endcond detail
+ **/
+
+/**
+ * @brief parse a large json array or object using several threads
+ *
+ * The members of the top-level container are split into chunks at the
+ * commas between them, the chunks are parsed concurrently, and the results
+ * are joined in order. The result is the same as that of @ref parse; input
+ * which is not a large container, or which the parallel pass rejects, is
+ * handed to @ref parse so that errors are reported the same way too.
+ *
+ * @param data the well-formed json to parse
+ * @param size the length of the json in bytes
+ * @param threads the number of threads to use, 0 for one per core
+ * @return the parsed json as a @ref value
+ * @throw @ref exception if parsing failed
+ **/
+inline value parse_parallel(const char *data, std::size_t size, unsigned threads = 0)
+{
+    static const std::size_t min_chunk_size = 64 * 1024;
+
+    if (!threads)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    auto end = data + size, p = detail::skip_whitespace(data, end);
+    if (threads < 2 || size < 2 * min_chunk_size || p == end || (*p != '[' && *p != '{') || max_depth() == 0)
+        return detail::parse_buffer<false>(data, size);
+
+    // A few chunks per thread smooths out uneven members
+    bool keyed = *p == '{';
+    std::vector<string_ref> chunks;
+    auto close = detail::split_members(p + 1, end, std::max(min_chunk_size, size / (threads * 8)), chunks);
+    std::vector<detail::parsed_chunk> parsed;
+    if (close == end || *close != (keyed ? '}' : ']') || detail::skip_whitespace(close + 1, end) != end || chunks.size() < 2 || !detail::parse_chunks(chunks, keyed, std::min<std::size_t>(threads, chunks.size()), parsed))
+        return detail::parse_buffer<false>(data, size);
+
+    std::size_t count = 0;
+    for (auto const &c : parsed)
+        count += c.values.size();
+    if (!keyed)
+    {
+        array rv;
+        rv.reserve(count);
+        for (auto &c : parsed)
+            std::move(c.values.begin(), c.values.end(), std::back_inserter(rv));
+        return rv;
+    }
+    object rv;
+    rv.reserve(count);
+    for (auto &c : parsed)
+    {
+        for (std::size_t i = 0; i < c.values.size(); ++i)
+            rv[std::move(c.keys[i])] = std::move(c.values[i]);
+    }
+    return rv;
+}
+
+/**
+ * @see parse_parallel(const char *, std::size_t, unsigned)
+ **/
+inline value parse_parallel(string const &s, unsigned threads = 0)
+{
+    return parse_parallel(s.data(), s.size(), threads);
+}
+
+/**
+ * @brief Base class for parse event handlers.
+ *
+ * @ref parse_events calls the handler's members statically, so a handler
+ * derives from this class and hides the events it is interested in; the
+ * rest do nothing. String and key references are only valid during the
+ * call. A handler can throw to stop parsing early.
+ **/
+struct handler
+{
+    void on_null() {}
+    void on_bool(bool) {}
+
+    /**
+     * Receives numbers as a @ref JSON_NUMBER value; see @ref value::number_type
+     **/
+    void on_number(value const &) {}
+    void on_string(string_ref) {}
+    void on_key(string_ref) {}
+    void on_start_array() {}
+    void on_end_array() {}
+    void on_start_object() {}
+    void on_end_object() {}
+};
+
+/**
+ * @brief parse json from a buffer, reporting it to a handler as events
+ * instead of building a @ref value
+ * @param data the well-formed json to parse
+ * @param size the length of the json in bytes
+ * @param h the @ref handler receiving the events
+ * @throw @ref exception if parsing failed
+ **/
+template <typename Handler>
+void parse_events(const char *data, std::size_t size, Handler &h)
+{
+    detail::buffer_iterator<false> i(data, data + size), e(data + size, data + size);
+    detail::parse_events(i, e, h);
+}
+
+/**
+ * @brief parse json from a string, reporting it to a handler as events
+ * @see parse_events(const char *, std::size_t, Handler &)
+ **/
+template <typename Handler>
+void parse_events(string const &s, Handler &h)
+{
+    parse_events(s.data(), s.size(), h);
+}
+
+/**
+ * @brief parse json from an input stream, reporting it to a handler as
+ * events
+ * @see parse_events(const char *, std::size_t, Handler &)
+ **/
+template <typename T, typename Handler>
+void parse_events(std::basic_istream<T> &istream, Handler &h)
+{
+    detail::iterator<T> i(istream);
+    detail::iterator<T> &e = i;
+    detail::parse_events(i, e, h);
+}
+
+namespace detail
+{
+template <typename Handler>
+class schema_checker;
+}
+
+/**
+ * @brief A compiled subset of JSON Schema, checked while parsing
+ *
+ * A schema is compiled from a json::value using these JSON Schema keywords:
+ *   - "type": a type name, or an array of them. The names are "null",
+ *     "boolean", "number", "integer", "string", "array" and "object"
+ *   - "properties": an object mapping keys to the schemas of their values
+ *   - "required": an array of keys that objects must have
+ *   - "additionalProperties": false to reject keys not in "properties"
+ *   - "items": the schema of every element of an array
+ *
+ * Other keywords are ignored, so an object without any of these keywords
+ * accepts anything.
+ *
+ * Passed to @ref parse or @ref validate, the schema is checked as the
+ * input is tokenized. Input that does not match fails at the first
+ * offending token, without building the rest of the tree.
+ **/
+class schema
+{
+private:
+    static const std::size_t any = std::size_t(-1);
+
+    // Bits of node::types, one per ValueType and one for integers
+    static const unsigned integer_bit = 1u << 6;
+    static const unsigned all_types = (1u << 7) - 1;
+
+    struct node
+    {
+        unsigned types{ all_types };
+        // The node of each declared property; only these are not additional
+        ordered_map<std::size_t> properties;
+        // The position of each required key among the required keys
+        ordered_map<std::size_t> required;
+        bool additional{ true };
+        std::size_t items{ any };
+    };
+
+    std::vector<node> _nodes;
+
+    template <typename Handler>
+    friend class detail::schema_checker;
+
+    static unsigned type_bits(value const &name)
+    {
+        static const char *const names[] = { "array", "boolean", "null", "number", "object", "string", "integer" };
+        if (!name.is_string())
+            throw exception("bad schema: type names must be strings");
+        for (unsigned i = 0; i < 7; ++i)
+        {
+            if (name.get_string() == names[i])
+                return 1u << i;
+        }
+        throw exception("bad schema: unknown type " + name.get_string());
+    }
+
+    std::size_t compile(value const &definition)
+    {
+        if (!definition.is_object())
+            throw exception("bad schema: schemas must be objects");
+        auto const &o = definition.get_object();
+        auto index = _nodes.size();
+        _nodes.emplace_back();
+
+        auto it = o.find("type");
+        if (it != o.end())
+        {
+            unsigned types = 0;
+            if (it->second.is_array())
+            {
+                for (auto const &t : it->second.get_array())
+                    types |= type_bits(t);
+            }
+            else
+            {
+                types = type_bits(it->second);
+            }
+            _nodes[index].types = types;
+        }
+
+        it = o.find("properties");
+        if (it != o.end())
+        {
+            if (!it->second.is_object())
+                throw exception("bad schema: properties must be an object");
+            for (auto const &p : it->second.get_object())
+            {
+                auto child = compile(p.second);
+                _nodes[index].properties[string_ref(p.first)] = child;
+            }
+        }
+
+        it = o.find("required");
+        if (it != o.end())
+        {
+            if (!it->second.is_array())
+                throw exception("bad schema: required must be an array");
+            for (auto const &k : it->second.get_array())
+            {
+                if (!k.is_string())
+                    throw exception("bad schema: required keys must be strings");
+                auto &required = _nodes[index].required;
+                required.emplace(k.get_string(), required.size());
+            }
+        }
+
+        it = o.find("additionalProperties");
+        if (it != o.end())
+        {
+            if (!it->second.is_bool())
+                throw exception("bad schema: only true and false are supported for additionalProperties");
+            _nodes[index].additional = it->second.get_bool();
+        }
+
+        it = o.find("items");
+        if (it != o.end())
+        {
+            auto child = compile(it->second);
+            _nodes[index].items = child;
+        }
+        return index;
+    }
+
+public:
+    /**
+     * @brief construct a schema accepting anything
+     **/
+    schema() { _nodes.emplace_back(); }
+
+    /**
+     * @brief compile a schema
+     * @param definition the JSON Schema to compile
+     * @throw @ref exception if the schema is malformed or uses "type",
+     * "properties", "required", "additionalProperties" or "items" in an
+     * unsupported way
+     **/
+    explicit schema(value const &definition) { compile(definition); }
+};
+
+/**
+ * @cond detail
+ **/
+namespace detail
+{
+
+/**
+ * Parse event handler checking events against a @ref schema before
+ * passing them on to another handler.
+ **/
+template <typename Handler>
+class schema_checker
+{
+private:
+    struct frame
+    {
+        std::size_t node;
+        std::size_t seen; // offset of the object's flags in _seen
+        std::size_t member; // node of the value after the last key
+    };
+
+    static const std::size_t any = schema::any;
+
+    schema const &_schema;
+    Handler &_handler;
+    std::vector<frame> _stack;
+    std::vector<bool> _seen; // required keys found, for every open object
+
+    static string describe(unsigned types)
+    {
+        static const char *const names[] = { "array", "boolean", "null", "number", "object", "string", "integer" };
+        string rv;
+        for (unsigned i = 0; i < 7; ++i)
+        {
+            if (!(types & 1u << i) || (i == 6 && types & 1u << JSON_NUMBER))
+                continue;
+            if (!rv.empty())
+                rv += " or ";
+            rv += names[i];
+        }
+        return rv;
+    }
+
+    // The schema node of the value starting now
+    std::size_t current() const
+    {
+        if (_stack.empty())
+            return 0;
+        auto const &top = _stack.back();
+        if (top.node == any)
+            return any;
+        if (top.seen == any)
+            return _schema._nodes[top.node].items;
+        return top.member;
+    }
+
+    std::size_t begin_value(ValueType type, value const *number = nullptr)
+    {
+        auto n = current();
+        if (n == any)
+            return n;
+        auto types = _schema._nodes[n].types;
+        if (types & 1u << type)
+            return n;
+        if (number && types & schema::integer_bit)
+        {
+            auto kind = number->number_type();
+            double d = number->get_number();
+            if (kind != JSON_DOUBLE || (std::isfinite(d) && d == std::floor(d)))
+                return n;
+        }
+        throw exception("schema: expected " + describe(types));
+    }
+
+    void open(ValueType type)
+    {
+        auto n = begin_value(type);
+        frame f{ n, any, any };
+        if (type == JSON_OBJECT && n != any)
+        {
+            f.seen = _seen.size();
+            _seen.resize(_seen.size() + _schema._nodes[n].required.size());
+        }
+        _stack.push_back(f);
+    }
+
+public:
+    schema_checker(schema const &s, Handler &handler)
+        : _schema(s)
+        , _handler(handler)
+    {
+    }
+
+    void on_null()
+    {
+        begin_value(JSON_NULL);
+        _handler.on_null();
+    }
+
+    void on_bool(bool b)
+    {
+        begin_value(JSON_BOOL);
+        _handler.on_bool(b);
+    }
+
+    void on_number(value &&n)
+    {
+        begin_value(JSON_NUMBER, &n);
+        _handler.on_number(std::move(n));
+    }
+
+    void on_string(string_ref s)
+    {
+        begin_value(JSON_STRING);
+        _handler.on_string(s);
+    }
+
+    void on_key(string_ref k)
+    {
+        auto &top = _stack.back();
+        if (top.node != any)
+        {
+            auto const &n = _schema._nodes[top.node];
+            auto it = n.properties.find(k);
+            if (it == n.properties.end())
+            {
+                if (!n.additional)
+                    throw exception("schema: unexpected key " + k.str());
+                top.member = any;
+            }
+            else
+            {
+                top.member = it->second;
+            }
+            if (!n.required.empty())
+            {
+                auto r = n.required.find(k);
+                if (r != n.required.end())
+                    _seen[top.seen + r->second] = true;
+            }
+        }
+        _handler.on_key(k);
+    }
+
+    void on_start_array()
+    {
+        open(JSON_ARRAY);
+        _handler.on_start_array();
+    }
+
+    void on_end_array()
+    {
+        _stack.pop_back();
+        _handler.on_end_array();
+    }
+
+    void on_start_object()
+    {
+        open(JSON_OBJECT);
+        _handler.on_start_object();
+    }
+
+    void on_end_object()
+    {
+        auto const &top = _stack.back();
+        if (top.node != any)
+        {
+            for (auto const &r : _schema._nodes[top.node].required)
+            {
+                if (!_seen[top.seen + r.second])
+                    throw exception("schema: missing key " + r.first.str());
+            }
+            _seen.resize(top.seen);
+        }
+        _stack.pop_back();
+        _handler.on_end_object();
+    }
+};
+
+template <typename Iterator>
+value parse(Iterator &cur, Iterator const &end, schema const &s)
+{
+    dom_builder<false> builder;
+    schema_checker<dom_builder<false>> checker(s, builder);
+    parse_events(cur, end, checker);
+    return std::move(builder.result());
+}
+
+} // namespace detail
+/**
+ * @endcond detail
+ **/
+
+/**
+ * @brief parse json which must match a schema
+ * @param s the json to parse
+ * @param sc the @ref schema the json must match
+ * @return the parsed json as a @ref value
+ * @throw @ref exception if parsing failed or the json does not match,
+ * as soon as the first offending token is read
+ **/
+inline value parse(string const &s, schema const &sc)
+{
+    detail::buffer_iterator<false> i(s.data(), s.data() + s.size()), e(s.data() + s.size(), s.data() + s.size());
+    return detail::parse(i, e, sc);
+}
+
+/**
+ * @brief parse json from an input stream, which must match a schema
+ * @see parse(string const &, schema const &)
+ **/
+template <typename T>
+value parse(std::basic_istream<T> &istream, schema const &sc)
+{
+    detail::iterator<T> i(istream);
+    detail::iterator<T> &e = i;
+    return detail::parse(i, e, sc);
+}
+
+/**
+ * @brief check json against a schema without building a @ref value
+ * @param data the json to check
+ * @param size the length of the json in bytes
+ * @param sc the @ref schema the json must match
+ * @throw @ref exception at the first token that is malformed or does not
+ * match
+ **/
+inline void validate(const char *data, std::size_t size, schema const &sc)
+{
+    handler ignore;
+    detail::schema_checker<handler> checker(sc, ignore);
+    parse_events(data, size, checker);
+}
+
+/**
+ * @see validate(const char *, std::size_t, schema const &)
+ **/
+inline void validate(string const &s, schema const &sc)
+{
+    validate(s.data(), s.size(), sc);
+}
+
+/**
+ * @brief A parsed json document whose nodes live in an arena.
+ *
+ * The reference-counted boxes holding the strings, arrays and objects
+ * created by @ref parse are carved out of the document's @ref arena, which
+ * saves one heap allocation per node. The buffers inside them, those of
+ * the std::vector, object map and std::string, still come from the heap,
+ * and clearing or reparsing the document still destroys the tree node by
+ * node; only the box memory is returned in one step. The arena is kept
+ * between parses, so its blocks are reused in a request loop.
+ *
+ * Copying a value out of the document copies it to the heap, along with
+ * any strings still referring to a file from @ref parse_file, so the copy
+ * stays valid after the next @ref parse or @ref clear. References to the
+ * tree itself, such as the one @ref root returns, do not.
+ **/
+class document
+{
+private:
+    json::arena _arena;
+    mapped_file _file;
+    value _root;
+
+public:
+    /**
+     * @brief construct an empty document
+     * @param block_size the block size of the underlying arena
+     **/
+    explicit document(std::size_t block_size = 64 * 1024)
+        : _arena(block_size)
+    {
+    }
+
+    document(document const &) = delete;
+    document &operator=(document const &) = delete;
+
+    ~document()
+    {
+        clear();
+    }
+
+    /**
+     * @brief parse json into the document, replacing its previous contents
+     * @param s the well-formed json to parse
+     * @return the root of the parsed document
+     * @throw @ref exception if parsing failed
+     **/
+    value &parse(string const &s)
+    {
+        clear();
+        detail::arena_scope scope(_arena);
+        _root = json::parse(s);
+        return _root;
+    }
+
+    /**
+     * @brief parse json from an input stream into the document
+     * @param istream the input stream from which to parse json
+     * @return the root of the parsed document
+     * @throw @ref exception if parsing failed
+     **/
+    template <typename T>
+    value &parse(std::basic_istream<T> &istream)
+    {
+        clear();
+        detail::arena_scope scope(_arena);
+        _root = json::parse(istream);
+        return _root;
+    }
+
+    /**
+     * @brief parse a file into the document without copying its strings
+     *
+     * The file is memory-mapped where supported and stays mapped while the
+     * document holds the tree, which keeps referring to it as with
+     * @ref parse_view.
+     *
+     * @param path the file containing the json to parse
+     * @return the root of the parsed document
+     * @throw @ref exception if the file could not be read or parsing failed
+     **/
+    value &parse_file(string const &path)
+    {
+        clear();
+        _file = mapped_file(path);
+        detail::arena_scope scope(_arena);
+        _root = parse_view(_file.data(), _file.size());
+        return _root;
+    }
+
+    /**
+     * @brief drop the parsed tree, recycle the arena and unmap any file
+     **/
+    void clear()
+    {
+        _root = value();
+        _arena.reset();
+        _file = mapped_file();
+    }
+
+    /**
+     * @return the root of the document
+     **/
+    value &root() { return _root; }
+    value const &root() const { return _root; }
+
+    /**
+     * @return the arena backing the document
+     **/
+    json::arena &arena() { return _arena; }
+};
+
+/**
+ * @brief Parses a sequence of json documents, such as newline-delimited
+ * json, one record at a time.
+ *
+ * Records may be separated by any whitespace. A record that fails to parse
+ * is reported with its error, and the stream resumes at the point of
+ * failure if that is on a later line than the record's start, or else after
+ * the next newline, so one bad line does not end the stream. That recovery
+ * is only sound for newline-delimited json: a malformed record spanning
+ * several lines, or one followed by another record on the same line, may be
+ * reported as several bad records. The
+ * input buffer and the parser state are reused from one record to the next.
+ *
+ * @code
+ * json::document_stream records(std::cin);
+ * for (auto const &r : records)
+ *     if (!r.ok())
+ *         std::cerr << "bad record at byte " << r.offset << ": " << r.error << '\n';
+ * @endcode
+ **/
+class document_stream
+{
+public:
+    /**
+     * @brief One record of the stream
+     **/
+    struct record
+    {
+        /** @brief the byte offset of the record in the input **/
+        std::size_t offset{ 0 };
+        /** @brief the parsed record, null if it was malformed **/
+        value data;
+        /** @brief why the record failed to parse, empty on success **/
+        string error;
+
+        bool ok() const { return error.empty(); }
+    };
+
+    /**
+     * @brief Input iterator over the records of a @ref document_stream
+     **/
+    class iterator
+    {
+    private:
+        document_stream *_stream;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = record;
+        using difference_type = std::ptrdiff_t;
+        using pointer = record const *;
+        using reference = record const &;
+
+        explicit iterator(document_stream *stream = nullptr)
+            : _stream(stream)
+        {
+            if (_stream && !_stream->next())
+                _stream = nullptr;
+        }
+
+        reference operator*() const { return _stream->_record; }
+        pointer operator->() const { return &_stream->_record; }
+
+        iterator &operator++()
+        {
+            if (!_stream->next())
+                _stream = nullptr;
+            return *this;
+        }
+
+        bool operator==(iterator const &other) const { return _stream == other._stream; }
+        bool operator!=(iterator const &other) const { return _stream != other._stream; }
+    };
+
+private:
+    static const std::size_t block_size = 64 * 1024;
+
+    std::istream *_istream{ nullptr };
+    std::vector<char> _window;
+    const char *_data{ nullptr };
+    std::size_t _size{ 0 };
+    std::size_t _pos{ 0 };
+    std::size_t _base{ 0 };
+    bool _eof{ true };
+    detail::dom_builder<false> _builder;
+    record _record;
+
+    // Drop the window before keep, then read the next block from the
+    // stream after what is left. Returns false once the input is exhausted.
+    bool more(std::size_t keep)
+    {
+        if (_eof)
+            return false;
+        std::size_t kept = _size - keep;
+        if (keep)
+            std::memmove(_window.data(), _window.data() + keep, kept);
+        _base += keep;
+        _pos = _pos > keep ? _pos - keep : 0;
+        if (_window.size() - kept < block_size)
+            _window.resize(std::max(_window.size() * 2, kept + block_size));
+        auto n = _istream->rdbuf()->sgetn(_window.data() + kept, _window.size() - kept);
+        _data = _window.data();
+        _size = kept + static_cast<std::size_t>(n > 0 ? n : 0);
+        if (_size == kept)
+            _eof = true;
+        return !_eof;
+    }
+
+    // Resume after the first newline at or after pos, where a record failed
+    void skip_line(std::size_t pos)
+    {
+        _pos = pos;
+        for (;;)
+        {
+            auto nl = static_cast<const char *>(std::memchr(_data + _pos, '\n', _size - _pos));
+            if (nl)
+            {
+                _pos = nl - _data + 1;
+                return;
+            }
+            _pos = _size;
+            if (!more(_size))
+                return;
+        }
+    }
+
+public:
+    /**
+     * @brief iterate the records in a caller-owned buffer
+     * @warning the buffer must outlive the stream
+     **/
+    document_stream(const char *data, std::size_t size)
+        : _data(data)
+        , _size(size)
+    {
+    }
+
+    /**
+     * @brief iterate the records in a string
+     * @warning the string must outlive the stream
+     **/
+    explicit document_stream(string const &s)
+        : document_stream(s.data(), s.size())
+    {
+    }
+
+    /**
+     * @brief iterate the records read from an input stream
+     **/
+    explicit document_stream(std::istream &istream)
+        : _istream(&istream)
+        , _eof(!istream.rdbuf())
+    {
+    }
+
+    document_stream(document_stream const &) = delete;
+    document_stream &operator=(document_stream const &) = delete;
+
+    /**
+     * @brief parse the next record
+     * @return false at the end of the input
+     **/
+    bool next()
+    {
+        for (;;)
+        {
+            _pos = detail::skip_whitespace(_data + _pos, _data + _size) - _data;
+            if (_pos == _size)
+            {
+                if (more(_size))
+                    continue;
+                return false;
+            }
+
+            // Offsets are kept from the start of the input, as refilling
+            // the window moves its contents
+            auto start = _base + _pos;
+            detail::buffer_iterator<false> cur(_data + _pos, _data + _size), end(_data + _size, _data + _size);
+#if JSON_INSTRUMENT
+            auto began = std::chrono::steady_clock::now();
+#endif
+            try
+            {
+                detail::tokenizer<detail::buffer_iterator<false>, detail::dom_builder<false>>(cur, end, _builder).parse_value();
+                auto stop = _base + (cur.ptr() + 1 - _data);
+                // A value touching the end of the window may continue past it
+                if (stop >= _base + _size && more(start - _base))
+                {
+                    _builder.reset();
+                    continue;
+                }
+                _record.offset = start;
+                _record.data = std::move(_builder.result());
+                _record.error.clear();
+                _pos = stop - _base;
+#if JSON_INSTRUMENT
+                if (hooks().on_parse)
+                {
+                    auto stats = _builder.stats();
+                    stats.input_bytes = stop - start;
+                    hooks().on_parse(stats, detail::seconds_since(began));
+                }
+                _builder.reset();
+#endif
+                return true;
+            }
+            catch (exception const &e)
+            {
+                _builder.reset();
+                if (cur.ptr() + 1 >= _data + _size && more(start - _base))
+                    continue;
+                _record.offset = start;
+                _record.data = value();
+                _record.error = e.what();
+                // A failure on a later line than the record's start may be
+                // the start of the next record, after one cut short
+                auto fail = std::min(static_cast<std::size_t>(cur.ptr() - _data), _size);
+                if (std::memchr(_data + (start - _base), '\n', fail - (start - _base)))
+                    _pos = fail;
+                else
+                    skip_line(fail);
+                return true;
+            }
+        }
+    }
+
+    /**
+     * @return the record parsed by the last call to @ref next
+     **/
+    record const &current() const { return _record; }
+
+    /**
+     * @return an iterator parsing the first remaining record
+     **/
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
+};
+
+/**
+ * @brief A resumable parser for json arriving in arbitrary chunks.
+ *
+ * Input is pushed in with @ref feed as it becomes available, for example
+ * from a non-blocking socket, and the parser keeps its state between
+ * calls. Containers are tracked on an explicit stack rather than by
+ * recursion. Once @ref ready reports a complete value it is collected
+ * with @ref take, after which the next value can be fed.
+ *
+ * The grammar is strict: commas are required between elements and may not
+ * trail the last one.
+ *
+ * @code
+ * json::push_parser p;
+ * ssize_t n;
+ * while ((n = read(fd, buf, sizeof buf)) > 0)
+ * {
+ *     for (std::size_t used = 0; used < std::size_t(n);)
+ *     {
+ *         used += p.feed(buf + used, std::size_t(n) - used);
+ *         if (p.ready())
+ *             handle(p.take());
+ *     }
+ * }
+ * @endcode
+ **/
+class push_parser
+{
+private:
+    enum state
+    {
+        VALUE,
+        ARRAY_FIRST,
+        ARRAY_NEXT,
+        OBJECT_FIRST,
+        OBJECT_KEY,
+        OBJECT_COLON,
+        OBJECT_NEXT,
+        STRING,
+        NUMBER,
+        LITERAL,
+        DONE
+    };
+
+    state _state{ VALUE };
+    std::vector<bool> _stack; // true for objects
+    detail::dom_builder<false> _builder;
+
+    // The token being scanned, escapes still in place
+    string _token;
+    string _scratch;
+    bool _key{ false };
+    bool _escaped{ false };
+    bool _pending_escape{ false };
+    const char *_literal{ nullptr };
+    std::size_t _matched{ 0 };
+
+    void end_value()
+    {
+        if (_stack.empty())
+            _state = DONE;
+        else
+            _state = _stack.back() ? OBJECT_NEXT : ARRAY_NEXT;
+    }
+
+    void close()
+    {
+        if (_stack.back())
+            _builder.on_end_object();
+        else
+            _builder.on_end_array();
+        _stack.pop_back();
+        end_value();
+    }
+
+    void start_string(bool key)
+    {
+        _token.clear();
+        _key = key;
+        _escaped = false;
+        _pending_escape = false;
+        _state = STRING;
+    }
+
+    void end_string()
+    {
+        auto s = detail::decode(detail::string_token{ _token, _escaped }, _scratch);
+        if (_key)
+        {
+            _builder.on_key(s);
+            _state = OBJECT_COLON;
+            return;
+        }
+        _builder.on_string(s);
+        end_value();
+    }
+
+    void end_number()
+    {
+        _builder.on_number(detail::to_number(_token.data(), _token.data() + _token.size()));
+        end_value();
+    }
+
+    void check_depth()
+    {
+        if (_stack.size() >= max_depth().load(std::memory_order_relaxed))
+            throw exception("maximum depth exceeded");
+    }
+
+    void start_value(char c)
+    {
+        switch (c)
+        {
+        case '"':
+            start_string(false);
+            return;
+        case '[':
+            check_depth();
+            _builder.on_start_array();
+            _stack.push_back(false);
+            _state = ARRAY_FIRST;
+            return;
+        case '{':
+            check_depth();
+            _builder.on_start_object();
+            _stack.push_back(true);
+            _state = OBJECT_FIRST;
+            return;
+        case '0' ... '9':
+        case '-':
+            _token.assign(1, c);
+            _state = NUMBER;
+            return;
+        case 't':
+            _literal = "true";
+            break;
+        case 'f':
+            _literal = "false";
+            break;
+        case 'n':
+            _literal = "null";
+            break;
+        default:
+            throw exception(string("bad json: ") + c);
+        }
+        _matched = 1;
+        _state = LITERAL;
+    }
+
+    void structural(char c)
+    {
+        switch (_state)
+        {
+        case ARRAY_FIRST:
+            if (c == ']')
+                return close();
+        // fall through
+        case VALUE:
+            return start_value(c);
+        case ARRAY_NEXT:
+            if (c == ',')
+                _state = VALUE;
+            else if (c == ']')
+                close();
+            else
+                throw exception("bad array");
+            return;
+        case OBJECT_FIRST:
+            if (c == '}')
+                return close();
+        // fall through
+        case OBJECT_KEY:
+            if (c != '"')
+                throw exception("bad object");
+            return start_string(true);
+        case OBJECT_COLON:
+            if (c != ':')
+                throw exception("bad object");
+            _state = VALUE;
+            return;
+        case OBJECT_NEXT:
+            if (c == ',')
+                _state = OBJECT_KEY;
+            else if (c == '}')
+                close();
+            else
+                throw exception("bad object");
+            return;
+        default:
+            return;
+        }
+    }
+
+    const char *scan_string(const char *p, const char *end)
+    {
+        while (p != end)
+        {
+            if (static_cast<unsigned char>(*p) < 0x20)
+                throw exception("bad string: unescaped control character");
+            if (_pending_escape)
+            {
+                _token += *p++;
+                _pending_escape = false;
+                continue;
+            }
+            auto q = detail::find_escape(p, end);
+            _token.append(p, q);
+            p = q;
+            if (p == end)
+                break;
+            if (static_cast<unsigned char>(*p) < 0x20)
+                throw exception("bad string: unescaped control character");
+            if (*p++ == '"')
+            {
+                end_string();
+                break;
+            }
+            _token += '\\';
+            _escaped = true;
+            _pending_escape = true;
+        }
+        return p;
+    }
+
+    const char *scan_literal(const char *p, const char *end)
+    {
+        for (; p != end && _literal[_matched]; ++p, ++_matched)
+        {
+            if (*p != _literal[_matched])
+                throw exception(string("bad json: ") + _literal);
+        }
+        if (!_literal[_matched])
+        {
+            if (*_literal == 'n')
+                _builder.on_null();
+            else
+                _builder.on_bool(*_literal == 't');
+            end_value();
+        }
+        return p;
+    }
+
+public:
+    push_parser() {}
+
+    /**
+     * @brief parse the next chunk of input
+     *
+     * Parsing stops after a complete value, leaving the rest of the chunk
+     * for the next call once the value has been taken.
+     *
+     * @param data the bytes that arrived
+     * @param size the number of bytes
+     * @return the number of bytes consumed
+     * @throw @ref exception if the input is malformed, after which the
+     * parser must be @ref reset
+     **/
+    std::size_t feed(const char *data, std::size_t size)
+    {
+        auto p = data, end = data + size;
+        while (p != end && _state != DONE)
+        {
+            switch (_state)
+            {
+            case STRING:
+                p = scan_string(p, end);
+                break;
+            case NUMBER:
+            {
+                auto q = p;
+                while (q != end && detail::is_number_char(*q))
+                    ++q;
+                _token.append(p, q);
+                p = q;
+                if (p != end)
+                    end_number();
+                break;
+            }
+            case LITERAL:
+                p = scan_literal(p, end);
+                break;
+            default:
+                p = detail::skip_whitespace(p, end);
+                if (p != end)
+                    structural(*p++);
+                break;
+            }
+        }
+        return p - data;
+    }
+
+    /**
+     * @see feed(const char *, std::size_t)
+     **/
+    std::size_t feed(string const &s)
+    {
+        return feed(s.data(), s.size());
+    }
+
+    /**
+     * @brief signal the end of the input, completing a number at the top
+     * level which could otherwise still continue
+     * @throw @ref exception if a value was started but is incomplete
+     **/
+    void finish()
+    {
+        if (_state == NUMBER && _stack.empty())
+            end_number();
+        if (_state != DONE && (_state != VALUE || !_stack.empty()))
+            throw exception("unexpected end of input");
+    }
+
+    /**
+     * @return true if a complete value is waiting to be taken
+     **/
+    bool ready() const { return _state == DONE; }
+
+    /**
+     * @return the number of containers currently open
+     **/
+    std::size_t depth() const { return _stack.size(); }
+
+    /**
+     * @brief collect the complete value and start on the next one
+     * @throw @ref exception if no value is ready
+     **/
+    value take()
+    {
+        if (_state != DONE)
+            throw exception("no complete value");
+        value rv = std::move(_builder.result());
+        _builder.reset();
+        _state = VALUE;
+        return rv;
+    }
+
+    /**
+     * @brief discard any partial value, e.g. after an error
+     **/
+    void reset()
+    {
+        _builder.reset();
+        _stack.clear();
+        _state = VALUE;
+    }
+};
+
+template<typename T>
+T get(value const &source);
+
+template<typename T>
+struct info
+{
+    static bool is(value const &source)
+    {
+        return std::is_convertible<value, T>();
+    }
+
+    static T get(value const &source)
+    {
+        assert(is(source));
+        return T(source);
+    }
+};
+
+#define SPECIALIZE_INFO(TYPE, JSON_NAME, GETTER) \
+    template<> \
+    struct info<TYPE> \
+    { \
+        static bool is(value const &source) \
+        { \
+            return source.is_##JSON_NAME();\
+        } \
+        \
+        static TYPE get(value const &source) \
+        { \
+            assert(is(source)); \
+            return static_cast<TYPE>(source.get_##GETTER()); \
+        } \
+    };
+
+
+SPECIALIZE_INFO(string, string, string);
+SPECIALIZE_INFO(bool, bool, bool);
+SPECIALIZE_INFO(float, number, number);
+SPECIALIZE_INFO(double, number, number);
+SPECIALIZE_INFO(int8_t, number, int64);
+SPECIALIZE_INFO(int16_t, number, int64);
+SPECIALIZE_INFO(int32_t, number, int64);
+SPECIALIZE_INFO(int64_t, number, int64);
+SPECIALIZE_INFO(uint8_t, number, uint64);
+SPECIALIZE_INFO(uint16_t, number, uint64);
+SPECIALIZE_INFO(uint32_t, number, uint64);
+SPECIALIZE_INFO(uint64_t, number, uint64);
+
+template<>
+struct info<string_ref>
+{
+    static bool is(value const &source)
+    {
+        return source.is_string();
+    }
+
+    static string_ref get(value const &source)
+    {
+        assert(is(source));
+        return source.get_string_ref();
+    }
+};
+
+template<typename ArrayType>
+struct array_info
+{
+    using value_type = typename ArrayType::value_type;
+
+    static bool is(value const &source)
+    {
+        if (!source.is_array())
+        {
+            return false;
+        }
+        auto const &array = source.get_array();
+        return std::find_if_not(array.begin(), array.end(), &info<value_type>::is) == array.end();
+    }
+    
+    static ArrayType get(value const &source)
+    {
+        assert(is(source));
+        auto const &array = source.get_array();
+        ArrayType rv;
+        rv.reserve(array.size());
+        std::transform(array.begin(), array.end(), std::back_inserter(rv), &json::get<value_type>);
+        return rv;
+    }
+};
+
+/**
+ * @cond detail
+ **/
+namespace detail
+{
+
+/**
+ * True for the arithmetic types json numbers convert to
+ **/
+template <typename T>
+struct is_number_type : std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>
+{
+};
+
+/**
+ * Convert the number v to a T
+ * @return false, leaving out unspecified, if T cannot represent v: it is
+ * out of range, or not integral where T is an integer
+ **/
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type convert(value const &v, T &out)
+{
+    double d = v.get_number();
+    if (std::fabs(d) > std::numeric_limits<T>::max())
+        return false;
+    out = static_cast<T>(d);
+    return true;
+}
+
+// std::numeric_limits<T>::max() + 1, a power of two and so exact as a double
+template <typename T>
+double integer_limit()
+{
+    return static_cast<double>(std::numeric_limits<T>::max() / 2 + 1) * 2;
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, bool>::type convert(value const &v, T &out)
+{
+    switch (v.number_type())
+    {
+    case JSON_INT64:
+    {
+        auto i = v.get_int64();
+        out = static_cast<T>(i);
+        return i >= std::numeric_limits<T>::min() && i <= std::numeric_limits<T>::max();
+    }
+    case JSON_UINT64:
+    {
+        auto u = v.get_uint64();
+        out = static_cast<T>(u);
+        return u <= static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+    }
+    default:
+    {
+        double d = v.get_number();
+        if (d != std::floor(d) || d < static_cast<double>(std::numeric_limits<T>::min()) || d >= integer_limit<T>())
+            return false;
+        out = static_cast<T>(d);
+        return true;
+    }
+    }
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, bool>::type convert(value const &v, T &out)
+{
+    switch (v.number_type())
+    {
+    case JSON_INT64:
+    {
+        auto i = v.get_int64();
+        out = static_cast<T>(i);
+        return i >= 0 && static_cast<std::uint64_t>(i) <= std::numeric_limits<T>::max();
+    }
+    case JSON_UINT64:
+    {
+        auto u = v.get_uint64();
+        out = static_cast<T>(u);
+        return u <= std::numeric_limits<T>::max();
+    }
+    default:
+    {
+        double d = v.get_number();
+        if (d != std::floor(d) || d < 0 || d >= integer_limit<T>())
+            return false;
+        out = static_cast<T>(d);
+        return true;
+    }
+    }
+}
+
+/**
+ * Whether T can represent the number v
+ **/
+template <typename T>
+bool fits(value const &v)
+{
+    T ignored;
+    return convert(v, ignored);
+}
+
+/**
+ * The number v as a T
+ * @throw @ref exception "invalid cast" if T cannot represent it
+ **/
+template <typename T>
+T number_as(value const &v)
+{
+    T rv;
+    if (!convert(v, rv))
+        throw exception("invalid cast");
+    return rv;
+}
+
+} // namespace detail
+/**
+ * @endcond detail
+ **/
+
+/**
+ * Arrays of numbers are checked with one type test per element and
+ * converted in a single loop into contiguous storage.
+ **/
+template<typename ArrayType>
+struct number_array_info
+{
+    using value_type = typename ArrayType::value_type;
+
+    static bool is(value const &source)
+    {
+        if (!source.is_array())
+        {
+            return false;
+        }
+        for (auto const &v : source.get_array())
+        {
+            if (!v.is_number() || !detail::fits<value_type>(v))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Convert into out, reusing its capacity
+     * @throw @ref exception if an element is not a number value_type can
+     * represent
+     **/
+    static void get(value const &source, ArrayType &out)
+    {
+        auto const &array = source.get_array();
+        out.resize(array.size());
+        auto p = out.data();
+        bool ok = true;
+        for (auto const &v : array)
+        {
+            ok &= v.is_number() && detail::convert(v, *p);
+            ++p;
+        }
+        if (!ok)
+        {
+            throw exception("invalid cast");
+        }
+    }
+
+    static ArrayType get(value const &source)
+    {
+        ArrayType rv;
+        get(source, rv);
+        return rv;
+    }
+};
+
+template<typename T, typename Allocator>
+struct info<std::vector<T, Allocator>>
+    : std::conditional<detail::is_number_type<T>::value, number_array_info<std::vector<T, Allocator>>,
+                       array_info<std::vector<T, Allocator>>>::type
+{};
+
+template<typename MapType>
+struct map_info
+{
+private:
+    template<typename M>
+    static auto reserve(M &map, std::size_t n, int) -> decltype(map.reserve(n), void())
+    {
+        map.reserve(n);
+    }
+
+    template<typename M>
+    static void reserve(M &, std::size_t, long)
+    {}
+
+public:
+    using key_type = typename MapType::key_type;
+    using mapped_type = typename MapType::mapped_type;
+
+    static bool is(value const &source)
+    {
+        if (!source.is_object())
+        {
+            return false;
+        }
+        if (!std::is_convertible<key_type, string>::value)
+        {
+            return false;
+        }
+        auto const &object = source.get_object();
+        return std::find_if_not(object.begin(), object.end(), [](object::value_type const &pair)
+        {
+            return info<mapped_type>::is(pair.second);
+        }) == object.end();
+    }
+    
+    static MapType get(value const &source)
+    {
+        assert(is(source));
+        auto const &object = source.get_object();
+        MapType map;
+        reserve(map, object.size(), 0);
+        for (auto const &pair : object)
+        {
+            map.emplace(pair.first, json::get<mapped_type>(pair.second));
+        }
+        return map;
+    }
+};
+
+
+template<typename Key, typename T, typename Compare, typename Allocator>
+struct info<std::map<Key, T, Compare, Allocator>> : map_info<std::map<Key, T, Compare, Allocator>>
+{};
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+struct info<std::unordered_map<Key, T, Hash, KeyEqual, Allocator>> : map_info<std::unordered_map<Key, T, Hash, KeyEqual, Allocator>>
+{};
+
+template<typename T>
+struct info<ordered_map<T>> : map_info<ordered_map<T>>
+{};
+
+#undef SPECIALIZE_INFO
+
+template<typename T>
+bool is(value const &source)
+{
+    return info<T>::is(source);
+}
+
+template<typename T>
+bool get(value const &source, T &value_out)
+{
+    if (!info<T>::is(source))
+    {
+        return false;
+    }
+    value_out = info<T>::get(source);
+    return true;
+}
+
+/**
+ * @brief convert an array of numbers, reusing the storage of value_out
+ * @return false, leaving value_out unchanged, if source is not an array
+ * of numbers
+ **/
+template<typename T, typename Allocator>
+typename std::enable_if<detail::is_number_type<T>::value, bool>::type get(value const &source, std::vector<T, Allocator> &value_out)
+{
+    using info_type = info<std::vector<T, Allocator>>;
+    if (!info_type::is(source))
+    {
+        return false;
+    }
+    info_type::get(source, value_out);
+    return true;
+}
+
+template<typename T>
+T get(value const &source)
+{
+    return info<T>::get(source);
+}
+
+template<typename T>
+bool get_member(value const &source, string const &key, T &value_out)
+{
+    if (!source.is_object())
+    {
+        return false;
+    }
 
-template <typename Iterator>
-value parse(Iterator &, Iterator const &);
+    auto const &object = source.get_object();
+    auto it = object.find(key);
+    if (it == object.end())
+    {
+        return false;
+    }
+    
+    return get(it->second, value_out);
+}
 
-template <typename Iterator>
-array parse_array(Iterator &cur, Iterator const &end)
+/**
+ * @brief look up a member by a key from a @ref key_table, which
+ * @ref ordered_object compares by pointer
+ **/
+template<typename T>
+bool get_member(value const &source, json::key const &key, T &value_out)
 {
-    array rv;
-    bool accept = true, has_elements = false;
-    do
+    if (!source.is_object())
+    {
+        return false;
+    }
+
+    auto const &object = source.get_object();
+    auto it = object.find(key);
+    if (it == object.end())
+    {
+        return false;
+    }
+    
+    return get(it->second, value_out);
+}
+
+
+class lazy_value;
+
+/**
+ * @brief The members of a lazily parsed object
+ **/
+using lazy_object = std::unordered_map<string, lazy_value>;
+
+/**
+ * @brief The elements of a lazily parsed array
+ **/
+using lazy_array = std::vector<lazy_value>;
+
+/**
+ * @brief A json value which is only parsed when it is accessed.
+ *
+ * The whole buffer is validated up front without building anything.
+ * After that, a lazy_value is just the span of its json text: looking up
+ * members or elements only scans the current level, skipping nested
+ * values by bracket matching, and @ref get parses a subtree on request.
+ *
+ * @warning the buffer must outlive every lazy_value referring to it
+ **/
+class lazy_value
+{
+private:
+    const char *_begin{ nullptr };
+    const char *_end{ nullptr };
+
+    lazy_value(const char *begin, const char *end, bool)
+        : _begin(begin)
+        , _end(end)
+    {
+    }
+
+    const char *skip_whitespace(const char *p) const
+    {
+        return detail::skip_whitespace(p, _end);
+    }
+
+    // Visit the members of an object until f returns false
+    template <typename F>
+    void each_member(F f) const
     {
-        if (is_whitespace(*cur))
+        if (type() != JSON_OBJECT)
+            throw exception("invalid cast");
+        string scratch;
+        auto p = skip_whitespace(_begin + 1);
+        while (p != _end && *p == '"')
         {
-            continue;
+            auto key_end = detail::skip_string(p + 1, _end);
+            string_ref raw(p + 1, key_end - p - 2);
+            p = skip_whitespace(skip_whitespace(key_end) + 1);
+            auto value_end = detail::skip_value(p, _end);
+            string_ref key = raw;
+            if (std::memchr(raw.data(), '\\', raw.size()))
+                key = detail::decode(detail::string_token{ raw, true }, scratch);
+            if (!f(key, lazy_value(p, value_end, true)))
+                return;
+            p = skip_whitespace(value_end);
+            if (p != _end && *p == ',')
+                p = skip_whitespace(p + 1);
+        }
+    }
+
+    // Visit the elements of an array until f returns false
+    template <typename F>
+    void each_element(F f) const
+    {
+        if (type() != JSON_ARRAY)
+            throw exception("invalid cast");
+        auto p = skip_whitespace(_begin + 1);
+        while (p != _end && *p != ']')
+        {
+            auto value_end = detail::skip_value(p, _end);
+            if (!f(lazy_value(p, value_end, true)))
+                return;
+            p = skip_whitespace(value_end);
+            if (p != _end && *p == ',')
+                p = skip_whitespace(p + 1);
+        }
+    }
+
+public:
+    /**
+     * @brief construct a lazy null
+     **/
+    lazy_value() {}
+
+    /**
+     * @brief validate json in a caller-owned buffer for lazy access
+     * @param data the json to parse
+     * @param size the length of the json in bytes
+     * @throw @ref exception if the json is malformed
+     **/
+    lazy_value(const char *data, std::size_t size)
+    {
+        handler validator;
+        parse_events(data, size, validator);
+        _end = data + size;
+        _begin = detail::skip_whitespace(data, _end);
+        _end = detail::skip_value(_begin, _end);
+    }
+
+    /**
+     * @brief validate json in a string for lazy access
+     * @see lazy_value(const char *, std::size_t)
+     **/
+    explicit lazy_value(string_ref s)
+        : lazy_value(s.data(), s.size())
+    {
+    }
+
+    /**
+     * @return the json @ref ValueType of the value
+     **/
+    ValueType type() const
+    {
+        if (_begin == _end)
+            return JSON_NULL;
+        switch (*_begin)
+        {
+        case '[':
+            return JSON_ARRAY;
+        case '{':
+            return JSON_OBJECT;
+        case '"':
+            return JSON_STRING;
+        case 't':
+        case 'f':
+            return JSON_BOOL;
+        case 'n':
+            return JSON_NULL;
+        default:
+            return JSON_NUMBER;
+        }
+    }
+
+    inline bool is_array() const { return type() == JSON_ARRAY; }
+    inline bool is_bool() const { return type() == JSON_BOOL; }
+    inline bool is_null() const { return type() == JSON_NULL; }
+    inline bool is_number() const { return type() == JSON_NUMBER; }
+    inline bool is_object() const { return type() == JSON_OBJECT; }
+    inline bool is_string() const { return type() == JSON_STRING; }
+
+    /**
+     * @return the unparsed json text of the value
+     **/
+    string_ref raw() const
+    {
+        return string_ref(_begin, _end - _begin);
+    }
+
+    /**
+     * @brief parse the value and everything below it
+     * @return the value as a @ref value
+     **/
+    value get() const
+    {
+        if (_begin == _end)
+            return value();
+        return detail::parse_buffer<false>(_begin, _end - _begin);
+    }
+
+    /**
+     * @brief find a member of an object without parsing any of its values
+     *
+     * The whole object is scanned, so that of duplicate keys the last one
+     * is found, as @ref parse keeps it.
+     *
+     * @param key the key to look for
+     * @param out set to the member's value if found
+     * @return true if the member exists
+     * @throw @ref exception if the value is not an object
+     **/
+    bool find(string_ref key, lazy_value &out) const
+    {
+        bool found = false;
+        each_member([&](string_ref k, lazy_value const &v) {
+            if (k == key)
+            {
+                out = v;
+                found = true;
+            }
+            return true;
+        });
+        return found;
+    }
+
+    /**
+     * @return the elements of an array, each of them unparsed
+     * @throw @ref exception if the value is not an array
+     **/
+    lazy_array get_array() const
+    {
+        lazy_array rv;
+        each_element([&](lazy_value const &v) {
+            rv.push_back(v);
+            return true;
+        });
+        return rv;
+    }
+
+    /**
+     * @brief find an element of an array without parsing any of them
+     * @param index the position of the element
+     * @param out set to the element if the array is long enough
+     * @return true if the element exists
+     * @throw @ref exception if the value is not an array
+     **/
+    bool find(std::size_t index, lazy_value &out) const
+    {
+        bool found = false;
+        each_element([&](lazy_value const &v) {
+            if (index--)
+                return true;
+            out = v;
+            found = true;
+            return false;
+        });
+        return found;
+    }
+
+    /**
+     * @return the members of an object, their values unparsed
+     * @throw @ref exception if the value is not an object
+     **/
+    lazy_object get_object() const
+    {
+        lazy_object rv;
+        each_member([&](string_ref k, lazy_value const &v) {
+            rv[k.str()] = v;
+            return true;
+        });
+        return rv;
+    }
+};
+
+template<typename T>
+bool is(lazy_value const &source)
+{
+    return info<T>::is(source.get());
+}
+
+template<typename T>
+bool get(lazy_value const &source, T &value_out)
+{
+    return get(source.get(), value_out);
+}
+
+inline bool get(lazy_value const &source, lazy_value &value_out)
+{
+    value_out = source;
+    return true;
+}
+
+template<typename T>
+T get(lazy_value const &source)
+{
+    return info<T>::get(source.get());
+}
+
+template<typename T>
+bool get_member(lazy_value const &source, string const &key, T &value_out)
+{
+    lazy_value member;
+    if (!source.is_object() || !source.find(key, member))
+    {
+        return false;
+    }
+
+    return get(member, value_out);
+}
+
+namespace detail
+{
+class path_extractor;
+}
+
+/**
+ * @brief A JSON Pointer (RFC 6901) parsed once for repeated lookups
+ *
+ * The pointer is split into reference tokens when it is constructed. Each
+ * token is kept as a @ref key with its hash computed, and also as an array
+ * index when it is one, so lookups do no string handling. "/a/b/3"
+ * refers to member "b" of member "a" and then to element 3 of an array or
+ * member "3" of an object. The empty pointer refers to the whole value.
+ *
+ * The precomputed hash is only used with JSON_ORDERED_OBJECT. The default
+ * std::unordered_map object hashes its key itself on every find, so there
+ * each token's name is hashed again at each lookup (without copying it).
+ **/
+class pointer
+{
+private:
+    struct token
+    {
+        json::key name;
+        std::size_t index; // npos unless the token is an array index
+    };
+
+    std::vector<token> _tokens;
+
+    friend class detail::path_extractor;
+
+    static std::size_t to_index(string const &s)
+    {
+        const std::size_t npos = string::npos;
+        if (s.empty() || s.size() > 19 || (s[0] == '0' && s.size() > 1))
+            return npos;
+        std::size_t rv = 0;
+        for (char c : s)
+        {
+            if (c < '0' || c > '9')
+                return npos;
+            rv = rv * 10 + (c - '0');
+        }
+        return rv;
+    }
+
+public:
+    /**
+     * @brief construct the pointer to the whole value
+     **/
+    pointer() {}
+
+    /**
+     * @brief parse a pointer
+     * @param path empty, or '/' followed by tokens separated by '/', in
+     * which "~1" stands for '/' and "~0" for '~'
+     * @throw @ref exception if the pointer is malformed
+     **/
+    explicit pointer(string_ref path)
+    {
+        if (path.empty())
+            return;
+        if (path[0] != '/')
+            throw exception("bad json pointer");
+        string name;
+        for (auto p = path.begin() + 1;; ++p)
+        {
+            if (p == path.end() || *p == '/')
+            {
+                _tokens.push_back(token{ detail::make_key(name), to_index(name) });
+                name.clear();
+                if (p == path.end())
+                    break;
+            }
+            else if (*p == '~')
+            {
+                if (++p == path.end() || (*p != '0' && *p != '1'))
+                    throw exception("bad json pointer");
+                name += *p == '0' ? '~' : '/';
+            }
+            else
+            {
+                name += *p;
+            }
+        }
+    }
+
+    /**
+     * @return the number of reference tokens
+     **/
+    std::size_t size() const { return _tokens.size(); }
+
+    /**
+     * @return the value the pointer refers to within root, or nullptr if
+     * there is none
+     **/
+    value const *find(value const &root) const
+    {
+        auto v = &root;
+        for (auto const &t : _tokens)
+        {
+            if (v->is_object())
+            {
+                auto const &o = v->get_object();
+                auto it = o.find(t.name);
+                if (it == o.end())
+                    return nullptr;
+                v = &it->second;
+            }
+            else if (v->is_array())
+            {
+                auto const &a = v->get_array();
+                if (t.index >= a.size())
+                    return nullptr;
+                v = &a[t.index];
+            }
+            else
+            {
+                return nullptr;
+            }
+        }
+        return v;
+    }
+
+    /**
+     * @return the value the pointer refers to within root
+     * @throw @ref exception if there is none
+     **/
+    value const &at(value const &root) const
+    {
+        if (auto v = find(root))
+            return *v;
+        throw exception("json pointer: no such value");
+    }
+
+    /**
+     * @brief find the value the pointer refers to within unparsed json,
+     * only scanning the containers on the way to it
+     * @param root the value to search
+     * @param out set to the value if found
+     * @return true if there is a value at the pointer
+     **/
+    bool find(lazy_value const &root, lazy_value &out) const
+    {
+        lazy_value v = root;
+        for (auto const &t : _tokens)
+        {
+            if (v.is_object() ? !v.find(t.name.str(), v) : !v.is_array() || !v.find(t.index, v))
+                return false;
+        }
+        out = v;
+        return true;
+    }
+};
+
+/**
+ * @brief look up a value any number of levels down
+ * @return false if there is no value at the pointer or it does not
+ * convert to T
+ **/
+template <typename T>
+bool get_member(value const &source, pointer const &path, T &value_out)
+{
+    auto v = path.find(source);
+    return v && get(*v, value_out);
+}
+
+/**
+ * @brief look up a value any number of levels down in unparsed json
+ * @see get_member(value const &, pointer const &, T &)
+ **/
+template <typename T>
+bool get_member(lazy_value const &source, pointer const &path, T &value_out)
+{
+    lazy_value member;
+    return path.find(source, member) && get(member, value_out);
+}
+
+/**
+ * @cond detail
+ **/
+namespace detail
+{
+
+/**
+ * Parse event handler building only the values at a set of pointers.
+ * Open containers are tracked with the key or index being parsed, and
+ * containers no pointer leads into are passed over without comparing
+ * anything.
+ **/
+class path_extractor : public handler
+{
+private:
+    struct frame
+    {
+        bool object;
+        bool live; // some pointer goes through this container
+        std::size_t index;
+        string key;
+    };
+
+    struct capture
+    {
+        std::size_t path;
+        std::size_t depth;
+        dom_builder<false> builder;
+    };
+
+    std::vector<pointer> const &_paths;
+    std::vector<value> &_out;
+    std::vector<frame> _stack;
+    std::vector<capture> _captures;
+    std::vector<bool> _done; // whether each pointer has had a value
+    std::size_t _found{ 0 }; // the pointers done
+
+    // Store the value of pointer i; a duplicate key replaces it, as in parse
+    void found(std::size_t i, value &&v)
+    {
+        _out[i] = std::move(v);
+        if (!_done[i])
+        {
+            _done[i] = true;
+            ++_found;
+        }
+    }
+
+    // Whether the first n tokens of p name the containers open now
+    bool on_path(pointer const &p, std::size_t n) const
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto const &f = _stack[i];
+            auto const &t = p._tokens[i];
+            if (f.object ? !(t.name == string_ref(f.key)) : t.index != f.index)
+                return false;
+        }
+        return true;
+    }
+
+    // Move on to the next value of the innermost container
+    // @return the number of open containers, or npos if no pointer leads
+    // into the innermost one
+    std::size_t next_value()
+    {
+        if (_stack.empty())
+            return 0;
+        auto &top = _stack.back();
+        if (!top.object)
+            ++top.index;
+        return top.live ? _stack.size() : string::npos;
+    }
+
+    template <typename F>
+    void scalar(F emit)
+    {
+        for (auto &c : _captures)
+            emit(c.builder);
+        auto depth = next_value();
+        if (depth == string::npos)
+            return;
+        for (std::size_t i = 0; i < _paths.size(); ++i)
+        {
+            if (_paths[i].size() != depth || !on_path(_paths[i], depth))
+                continue;
+            dom_builder<false> b;
+            emit(b);
+            found(i, std::move(b.result()));
         }
-        else if (*cur == ']' && (has_elements ^ accept))
+        finish();
+    }
+
+    void open(bool object)
+    {
+        for (auto &c : _captures)
         {
-            // !accept = strict (no trailing commas)
-            return rv;
+            if (object)
+                c.builder.on_start_object();
+            else
+                c.builder.on_start_array();
         }
-        else if (accept)
+        auto depth = next_value();
+        bool live = false;
+        for (std::size_t i = 0; depth != string::npos && i < _paths.size(); ++i)
         {
-            rv.push_back(parse(cur, end));
-            has_elements = true;
-            accept = false;
+            auto const &p = _paths[i];
+            if (p.size() < depth || !on_path(p, depth))
+                continue;
+            if (p.size() > depth)
+            {
+                live = true;
+                continue;
+            }
+            _captures.push_back(capture{ i, depth + 1, dom_builder<false>() });
+            if (object)
+                _captures.back().builder.on_start_object();
+            else
+                _captures.back().builder.on_start_array();
         }
-        else if (*cur == ',')
+        _stack.push_back(frame{ object, live, std::size_t(-1), string() });
+    }
+
+    void close(bool object)
+    {
+        for (auto &c : _captures)
         {
-            accept = true;
+            if (object)
+                c.builder.on_end_object();
+            else
+                c.builder.on_end_array();
         }
-        else
+        _stack.pop_back();
+        for (auto i = _captures.size(); i--;)
         {
-            break;
+            if (_captures[i].depth > _stack.size())
+            {
+                found(_captures[i].path, std::move(_captures[i].builder.result()));
+                _captures.erase(_captures.begin() + i);
+            }
         }
-    } while (++cur != end);
-    throw exception("bad array");
-}
+        finish();
+    }
 
-template <typename Iterator>
-value parse_number(Iterator &cur, Iterator const &end)
-{
-    std::stringstream io;
-    do
+    // Stop parsing once every pointer has its value
+    void finish()
     {
-        io << *cur;
-        auto next = cur + 1;
-        if (!isdigit(*next) && *next != '-' && *next != '.' && *next != 'e' && *next != 'E' && *next != '+')
-        {
-            break;
-        }
-    } while (++cur != end);
-    io.seekg(0);
-    double d = 0;
-    io >> d;
-    return d;
-}
+        if (_found == _paths.size() && _captures.empty())
+            throw complete();
+    }
 
-template <typename Iterator>
-string parse_string(Iterator &cur, Iterator const &end)
+public:
+    struct complete
+    {
+    };
+
+    path_extractor(std::vector<pointer> const &paths, std::vector<value> &out)
+        : _paths(paths)
+        , _out(out)
+        , _done(paths.size())
+    {
+        _captures.reserve(paths.size());
+    }
+
+    std::size_t found() const { return _found; }
+
+    void on_null()
+    {
+        scalar([](dom_builder<false> &b) { b.on_null(); });
+    }
+
+    void on_bool(bool x)
+    {
+        scalar([x](dom_builder<false> &b) { b.on_bool(x); });
+    }
+
+    void on_number(value const &n)
+    {
+        scalar([&n](dom_builder<false> &b) { b.on_number(value(n)); });
+    }
+
+    void on_string(string_ref s)
+    {
+        scalar([s](dom_builder<false> &b) { b.on_string(s); });
+    }
+
+    void on_key(string_ref k)
+    {
+        for (auto &c : _captures)
+            c.builder.on_key(k);
+        auto &top = _stack.back();
+        if (top.live)
+            top.key.assign(k.data(), k.size());
+    }
+
+    void on_start_array() { open(false); }
+    void on_end_array() { close(false); }
+    void on_start_object() { open(true); }
+    void on_end_object() { close(true); }
+};
+
+} // namespace detail
+/**
+ * @endcond detail
+ **/
+
+/**
+ * @brief pull the values at several pointers out of json text in one pass
+ *
+ * Only the values the pointers refer to are built; the rest of the text
+ * is tokenized and dropped. Parsing stops as soon as every pointer has
+ * its value, so the text after that point is not checked.
+ *
+ * @param data the json to parse
+ * @param size the length of the json in bytes
+ * @param paths the pointers to look for
+ * @param values set to one value per pointer, null where the pointer
+ * refers to nothing
+ * @return the number of pointers that refer to a value
+ * @throw @ref exception if the json is malformed before the last value
+ **/
+inline std::size_t extract(const char *data, std::size_t size, std::vector<pointer> const &paths, std::vector<value> &values)
 {
-    string rv;
-    for (bool esc = false; cur != end; ++cur)
+    values.assign(paths.size(), value());
+    detail::path_extractor h(paths, values);
+    try
+    {
+        if (!paths.empty())
+            parse_events(data, size, h);
+    }
+    catch (detail::path_extractor::complete const &)
     {
-        if (*cur == '"' && !esc)
-            return rv;
-        esc = *cur == '\\' && !esc;
-        if (!esc)
-            rv += *cur;
     }
-    throw exception(string("bad string: ") + rv);
+    return h.found();
 }
 
-template <typename Iterator>
-object parse_object(Iterator &cur, Iterator const &end)
+/**
+ * @see extract(const char *, std::size_t, std::vector<pointer> const &, std::vector<value> &)
+ **/
+inline std::size_t extract(string const &s, std::vector<pointer> const &paths, std::vector<value> &values)
 {
-    object rv;
-    string key;
-    bool got_key = false, got_elements = false;
-    do
+    return extract(s.data(), s.size(), paths, values);
+}
+
+/**
+ * @cond detail
+ **/
+#define JSON_DETAIL_EXPAND(x) x
+#define JSON_DETAIL_FIELD(f) v(::json::string_ref(#f, sizeof(#f) - 1), o.f);
+#define JSON_DETAIL_FIELDS_1(m, a) m(a)
+#define JSON_DETAIL_FIELDS_2(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_1(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_3(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_2(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_4(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_3(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_5(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_4(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_6(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_5(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_7(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_6(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_8(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_7(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_9(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_8(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_10(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_9(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_11(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_10(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_12(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_11(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_13(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_12(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_14(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_13(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_15(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_14(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_16(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_15(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_17(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_16(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_18(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_17(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_19(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_18(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_20(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_19(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_21(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_20(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_22(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_21(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_23(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_22(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_24(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_23(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_25(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_24(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_26(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_25(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_27(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_26(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_28(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_27(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_29(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_28(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_30(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_29(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_31(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_30(m, __VA_ARGS__))
+#define JSON_DETAIL_FIELDS_32(m, a, ...) m(a) JSON_DETAIL_EXPAND(JSON_DETAIL_FIELDS_31(m, __VA_ARGS__))
+#define JSON_DETAIL_PICK( \
+    _1, _2, _3, _4, _5, _6, _7, _8, \
+    _9, _10, _11, _12, _13, _14, _15, _16, \
+    _17, _18, _19, _20, _21, _22, _23, _24, \
+    _25, _26, _27, _28, _29, _30, _31, _32, NAME, ...) NAME
+#define JSON_DETAIL_FOR_EACH(m, ...) \
+    JSON_DETAIL_EXPAND(JSON_DETAIL_PICK(__VA_ARGS__, \
+        JSON_DETAIL_FIELDS_32, JSON_DETAIL_FIELDS_31, JSON_DETAIL_FIELDS_30, JSON_DETAIL_FIELDS_29, \
+        JSON_DETAIL_FIELDS_28, JSON_DETAIL_FIELDS_27, JSON_DETAIL_FIELDS_26, JSON_DETAIL_FIELDS_25, \
+        JSON_DETAIL_FIELDS_24, JSON_DETAIL_FIELDS_23, JSON_DETAIL_FIELDS_22, JSON_DETAIL_FIELDS_21, \
+        JSON_DETAIL_FIELDS_20, JSON_DETAIL_FIELDS_19, JSON_DETAIL_FIELDS_18, JSON_DETAIL_FIELDS_17, \
+        JSON_DETAIL_FIELDS_16, JSON_DETAIL_FIELDS_15, JSON_DETAIL_FIELDS_14, JSON_DETAIL_FIELDS_13, \
+        JSON_DETAIL_FIELDS_12, JSON_DETAIL_FIELDS_11, JSON_DETAIL_FIELDS_10, JSON_DETAIL_FIELDS_9, \
+        JSON_DETAIL_FIELDS_8, JSON_DETAIL_FIELDS_7, JSON_DETAIL_FIELDS_6, JSON_DETAIL_FIELDS_5, \
+        JSON_DETAIL_FIELDS_4, JSON_DETAIL_FIELDS_3, JSON_DETAIL_FIELDS_2, JSON_DETAIL_FIELDS_1)(m, __VA_ARGS__))
+/**
+ * @endcond detail
+ **/
+
+/**
+ * @brief Bind the listed members of TYPE to json object fields of the
+ * same names, for @ref read and @ref write.
+ *
+ * Use it at namespace scope, in the namespace of TYPE:
+ * @code
+ * struct request { std::string user; int id; std::vector<double> weights; };
+ * JSON_FIELDS(request, user, id, weights)
+ * @endcode
+ **/
+#define JSON_FIELDS(TYPE, ...) \
+    template <typename JsonObject, typename JsonVisitor> \
+    typename std::enable_if<std::is_same<typename std::remove_const<JsonObject>::type, TYPE>::value>::type \
+    json_fields(JsonObject &o, JsonVisitor &v) \
+    { \
+        JSON_DETAIL_FOR_EACH(JSON_DETAIL_FIELD, __VA_ARGS__) \
+    }
+
+/**
+ * @cond detail
+ **/
+namespace detail
+{
+
+struct field_probe
+{
+    template <typename M>
+    void operator()(string_ref, M &) {}
+};
+
+/**
+ * Whether T has its fields bound with @ref JSON_FIELDS
+ **/
+template <typename T>
+struct has_fields
+{
+    template <typename U>
+    static auto test(int) -> decltype(json_fields(std::declval<U &>(), std::declval<field_probe &>()), std::true_type());
+    template <typename U>
+    static std::false_type test(...);
+
+    static const bool value = decltype(test<T>(0))::value;
+};
+
+/**
+ * Parses json from a buffer straight into typed storage.
+ **/
+class struct_reader
+{
+private:
+    const char *_p;
+    const char *_end;
+    string _scratch;
+
+    struct field_reader
     {
-        if (*cur == '}' && !got_key)
+        struct_reader &reader;
+        string_ref key;
+        bool found;
+
+        template <typename F>
+        void operator()(string_ref name, F &member)
         {
-            return rv;
+            if (!found && name == key)
+            {
+                found = true;
+                reader.read(member);
+            }
         }
-        else if (is_whitespace(*cur))
+    };
+
+    char next()
+    {
+        _p = skip_whitespace(_p, _end);
+        return _p != _end ? *_p : '\0';
+    }
+
+    void expect(char c, const char *error)
+    {
+        if (next() != c)
+            throw exception(error);
+        ++_p;
+    }
+
+    // Consume a comma or the closing bracket; true at the closing bracket
+    bool end_of(char close, const char *error)
+    {
+        char c = next();
+        ++_p;
+        if (c == close)
+            return true;
+        if (c != ',')
+            throw exception(error);
+        return false;
+    }
+
+    string_ref read_string()
+    {
+        if (next() != '"')
+            throw exception("invalid cast");
+        buffer_iterator<false> cur(_p + 1, _end), e(_end, _end);
+        auto t = scan_string(cur, e, _scratch);
+        _p = cur.ptr() + 1;
+        return decode(t, _scratch);
+    }
+
+    value read_number()
+    {
+        char c = next();
+        if (c != '-' && !is_digit(c))
+            throw exception("invalid cast");
+        buffer_iterator<false> cur(_p, _end), e(_end, _end);
+        auto v = parse_number(cur, e);
+        _p = cur.ptr() + 1;
+        return v;
+    }
+
+    template <typename T, typename Allocator>
+    void read_elements(std::vector<T, Allocator> &v, std::false_type)
+    {
+        do
         {
-            continue;
-        }
-        else if (*cur == '"')
+            v.emplace_back();
+            read(v.back());
+        } while (!end_of(']', "bad array"));
+    }
+
+    // Numbers are converted straight from the text into the vector,
+    // stepping over the usual single space without calling out
+    template <typename T, typename Allocator>
+    void read_elements(std::vector<T, Allocator> &v, std::true_type)
+    {
+        for (;;)
         {
-            key = parse_string(++cur, end);
-            got_key = true;
+            if (_p != _end && is_whitespace(*_p))
+                next();
+            auto begin = _p;
+            if (_p != _end && (*_p == '-' || is_digit(*_p)))
+                ++_p;
+            else
+                throw exception("invalid cast");
+            while (_p != _end && is_number_char(*_p))
+                ++_p;
+            v.push_back(to_number_as<T>(begin, _p));
+            if (_p != _end && is_whitespace(*_p))
+                next();
+            char c = _p != _end ? *_p++ : '\0';
+            if (c == ']')
+                return;
+            if (c != ',')
+                throw exception("bad array");
         }
-        else if (got_key && *cur == ':')
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value, T>::type to_number_as(const char *begin, const char *end)
+    {
+        return static_cast<T>(to_double(begin, end));
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value, T>::type to_number_as(const char *begin, const char *end)
+    {
+        return number_as<T>(to_number(begin, end));
+    }
+
+    template <typename Handler>
+    void parse_value(Handler &h)
+    {
+        next();
+        buffer_iterator<false> cur(_p, _end), e(_end, _end);
+        tokenizer<buffer_iterator<false>, Handler>(cur, e, h).parse_value();
+        _p = cur.ptr() + 1;
+    }
+
+    template <typename M>
+    void read_map(M &m)
+    {
+        m.clear();
+        expect('{', "invalid cast");
+        if (next() == '}')
         {
-            rv[key] = parse(++cur, end);
-            got_key = false;
-            got_elements = true;
+            ++_p;
+            return;
         }
-        else if (got_elements && !got_key && *cur == ',')
+        do
         {
-            continue;
-        }
+            auto k = read_string().str();
+            expect(':', "bad object");
+            read(m[k]);
+        } while (!end_of('}', "bad object"));
+    }
+
+public:
+    struct_reader(const char *data, std::size_t size)
+        : _p(data)
+        , _end(data + size)
+    {
+    }
+
+    void read(bool &b)
+    {
+        char c = next();
+        if (c == 't' && _end - _p >= 4 && !std::memcmp(_p, "true", 4))
+            b = true;
+        else if (c == 'f' && _end - _p >= 5 && !std::memcmp(_p, "false", 5))
+            b = false;
         else
+            throw exception("invalid cast");
+        _p += b ? 4 : 5;
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type read(T &x)
+    {
+        x = number_as<T>(read_number());
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type read(T &x)
+    {
+        x = number_as<T>(read_number());
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_floating_point<T>::value>::type read(T &x)
+    {
+        x = static_cast<T>(read_number().get_number());
+    }
+
+    void read(string &s)
+    {
+        auto r = read_string();
+        s.assign(r.data(), r.size());
+    }
+
+    void read(value &v)
+    {
+        dom_builder<false> builder;
+        parse_value(builder);
+        v = std::move(builder.result());
+    }
+
+    template <typename T, typename Allocator>
+    void read(std::vector<T, Allocator> &v)
+    {
+        v.clear();
+        expect('[', "invalid cast");
+        if (next() == ']')
         {
-            break;
+            ++_p;
+            return;
         }
-    } while (++cur != end);
-    throw exception("bad object");
-}
+        read_elements(v, is_number_type<T>());
+    }
 
-template <typename Iterator>
-value parse(Iterator &cur, Iterator const &end)
-{
-    do
+    template <typename T, typename Compare, typename Allocator>
+    void read(std::map<string, T, Compare, Allocator> &m)
     {
-        switch (*cur)
+        read_map(m);
+    }
+
+    template <typename T, typename Hash, typename KeyEqual, typename Allocator>
+    void read(std::unordered_map<string, T, Hash, KeyEqual, Allocator> &m)
+    {
+        read_map(m);
+    }
+
+    template <typename T>
+    typename std::enable_if<has_fields<T>::value>::type read(T &o)
+    {
+        expect('{', "invalid cast");
+        if (next() == '}')
         {
-        case '"':
-            return parse_string(++cur, end);
-        case '[':
-            return parse_array(++cur, end);
-        case '{':
-            return parse_object(++cur, end);
-        case '0' ... '9':
-        case '-':
-            return parse_number(cur, end);
-        case 'n':
-            if (*++cur == 'u' && *++cur == 'l' && *++cur == 'l')
-                return value();
-            throw exception("bad json: null");
-        case 't':
-            if (*++cur == 'r' && *++cur == 'u' && *++cur == 'e')
-                return true;
-            throw exception(string("bad json: ") + *cur);
-        case 'f':
-            if (*++cur == 'a' && *++cur == 'l' && *++cur == 's' && *++cur == 'e')
-                return false;
-            throw exception("bad json: false");
-        case ' ':
-        case '\r':
-        case '\n':
-        case '\t':
-            ++cur;
-            continue;
-        default:
-            throw exception("bad json");
+            ++_p;
+            return;
         }
-    } while (cur != end);
-    throw exception("bad json");
-}
+        do
+        {
+            field_reader f{ *this, read_string(), false };
+            expect(':', "bad object");
+            json_fields(o, f);
+            if (!f.found)
+            {
+                // Unknown fields are validated and skipped
+                handler skip;
+                parse_value(skip);
+            }
+        } while (!end_of('}', "bad object"));
+    }
 
-template <typename T>
-class peek
+    /**
+     * Check that only whitespace is left.
+     **/
+    void finish()
+    {
+        if (next())
+            throw exception(string("garbage at end of input: ") + *_p);
+    }
+};
+
+/**
+ * Serializes typed storage as json through a @ref writer.
+ **/
+template <typename Sink>
+class struct_writer
 {
 private:
-    T v;
+    Sink &_sink;
+    writer<Sink> _writer;
+
+    struct field_writer
+    {
+        struct_writer &w;
+        bool first;
+
+        template <typename F>
+        void operator()(string_ref name, F const &member)
+        {
+            if (!first)
+                w._sink.append(", ", 2);
+            first = false;
+            w._writer.write_string(name.data(), name.size());
+            w._sink.append(": ", 2);
+            w.write(member);
+        }
+    };
+
+    template <typename M>
+    void write_map(M const &m)
+    {
+        _sink.put('{');
+        bool first = true;
+        for (auto const &i : m)
+        {
+            if (!first)
+                _sink.append(", ", 2);
+            first = false;
+            _writer.write_string(i.first);
+            _sink.append(": ", 2);
+            write(i.second);
+        }
+        _sink.put('}');
+    }
 
 public:
-    peek(T v)
-        : v(v)
+    explicit struct_writer(Sink &sink)
+        : _sink(sink)
+        , _writer(sink)
     {
     }
-    T operator*() const
+
+    void write(bool b)
     {
-        return v;
+        _sink.append(bool_branch[b], b ? 4 : 5);
     }
-};
 
-template <typename T>
-class iterator
-{
-private:
-    std::basic_istream<T> &istream;
-    T cur_val;
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type write(T x)
+    {
+        _writer.write_int(x);
+    }
 
-public:
-    iterator(std::basic_istream<T> &is)
-        : istream(is)
-        , cur_val(is.get())
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type write(T x)
+    {
+        _writer.write_uint(x);
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_floating_point<T>::value>::type write(T x)
+    {
+        _writer.write_double(x);
+    }
+
+    void write(float x)
+    {
+        _writer.write_float(x);
+    }
+
+    void write(string const &s)
+    {
+        _writer.write_string(s);
+    }
+
+    void write(value const &v)
+    {
+        _writer.write(v);
+    }
+
+    template <typename T, typename Allocator>
+    void write(std::vector<T, Allocator> const &v)
     {
+        write(v.data(), v.size());
     }
 
-    iterator &operator++()
+    template <typename T>
+    void write(T const *data, std::size_t size)
     {
-        istream.get(cur_val);
-        return *this;
+        _sink.put('[');
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            if (i)
+                _sink.append(", ", 2);
+            write(data[i]);
+        }
+        _sink.put(']');
     }
 
-    T operator*() const
+    template <typename T, typename Compare, typename Allocator>
+    void write(std::map<string, T, Compare, Allocator> const &m)
     {
-        return cur_val;
+        write_map(m);
     }
 
-    peek<T> operator+(int i) const
+    template <typename T, typename Hash, typename KeyEqual, typename Allocator>
+    void write(std::unordered_map<string, T, Hash, KeyEqual, Allocator> const &m)
     {
-        // Assumes you are peeking
-        return istream.peek();
-    };
+        write_map(m);
+    }
 
-    bool operator!=(iterator const &other) const
+    template <typename T>
+    typename std::enable_if<has_fields<T>::value>::type write(T const &o)
     {
-        // Assumes you are checking against the end iterator
-        return istream.good();
+        _sink.put('{');
+        field_writer f{ *this, true };
+        json_fields(o, f);
+        _sink.put('}');
     }
 };
 
-inline string array_wrapper::json() const
+} // namespace detail
+/**
+ * @endcond detail
+ **/
+
+/**
+ * @brief parse json directly into a typed object, without building a
+ * @ref value
+ *
+ * T may be bool, an arithmetic type, @ref string, @ref value, a
+ * std::vector, a std::map or std::unordered_map with string keys, or a
+ * type whose fields are bound with @ref JSON_FIELDS. Fields missing from
+ * the input keep their current contents; unknown fields are skipped.
+ *
+ * @param data the json to parse
+ * @param size the length of the json in bytes
+ * @param out the object to fill in
+ * @throw @ref exception if the json is malformed or does not match T
+ **/
+template <typename T>
+void read(const char *data, std::size_t size, T &out)
 {
-    std::stringstream ss;
-    ss << *_value;
-    return ss.str();
+    detail::struct_reader reader(data, size);
+    reader.read(out);
+    reader.finish();
 }
 
-inline string object_wrapper::json() const
+/**
+ * @see read(const char *, std::size_t, T &)
+ **/
+template <typename T>
+void read(string const &s, T &out)
 {
-    std::stringstream ss;
-    ss << *_value;
-    return ss.str();
+    read(s.data(), s.size(), out);
 }
 
-inline object const &object_wrapper::get_object() const
+/**
+ * @see read(const char *, std::size_t, T &)
+ * @return a T parsed from s
+ **/
+template <typename T>
+T read(string const &s)
 {
-    return *_value;
+    T rv;
+    read(s, rv);
+    return rv;
 }
 
-inline object &object_wrapper::get_object()
+/**
+ * @brief serialize a typed object as json, appending to out
+ * @see read(const char *, std::size_t, T &) for the supported types
+ **/
+template <typename T>
+void write(T const &v, string &out)
 {
-    return *_value;
+    detail::string_sink sink(out);
+    detail::struct_writer<detail::string_sink>(sink).write(v);
 }
 
-} // namespace detail
 /**
- * @endcond detail
+ * @return a typed object serialized as json
+ * @see read(const char *, std::size_t, T &) for the supported types
  **/
+template <typename T>
+string write(T const &v)
+{
+    string rv;
+    write(v, rv);
+    return rv;
+}
 
 /**
- * @brief parse json into a @ref value
- * @param s the well-formed json to parse
- * @return the parsed json as a @ref value
- * @throw @ref exception if parsing failed
+ * @brief serialize a contiguous buffer as a json array, appending to out
+ *
+ * Numeric buffers, such as feature vectors, are formatted in one pass
+ * without building a @ref value for each element.
+ *
+ * @param data the first element
+ * @param size the number of elements
+ * @param out the string to append the array to
+ * @see read(const char *, std::size_t, T &) for the supported types
  **/
-inline value parse(string const &s)
+template <typename T>
+void write(T const *data, std::size_t size, string &out)
 {
-    auto i = s.begin(), e = s.end();
-    auto v = detail::parse(i, e);
+    detail::string_sink sink(out);
+    detail::struct_writer<detail::string_sink>(sink).write(data, size);
+}
 
-    while (++i != e)
-    {
-        if (!detail::is_whitespace(*i))
-            throw exception(string("garbage at end of input: ") + *i);
-    }
+/**
+ * @cond detail
+ **/
+namespace detail
+{
 
-    return v;
-}
+/*
+ * CBOR (RFC 8949) major types, in the top three bits of each item's
+ * initial byte. The low five bits hold the argument, or say how many
+ * bytes of big-endian argument follow.
+ */
+enum cbor_major : unsigned char
+{
+    cbor_uint = 0x00,
+    cbor_negative = 0x20,
+    cbor_bytes = 0x40,
+    cbor_text = 0x60,
+    cbor_array = 0x80,
+    cbor_map = 0xa0,
+    cbor_tag = 0xc0,
+    cbor_simple = 0xe0,
+};
 
 /**
- * @brief parse json from an input stream
- * @param istream the input stream from which to parse json
- * @return the parsed json as a @ref value
- * @throw @ref exception if parsing failed
+ * Serializes a value as CBOR. Integers are written in the fewest bytes,
+ * doubles as single precision when that is exact.
  **/
-template <typename T>
-value parse(std::basic_istream<T> &istream)
+template <typename Sink>
+class cbor_writer
 {
-    detail::iterator<T> i(istream);
-    detail::iterator<T> &e = i;
-    auto v = detail::parse(i, e);
+private:
+    Sink &_sink;
 
-    while (++i != e)
+    void write_be(std::uint64_t x, unsigned bytes)
     {
-        if (!detail::is_whitespace(*i))
-            throw exception(string("garbage at end of input: ") + *i);
+        char buf[8];
+        for (unsigned i = bytes; i--; x >>= 8)
+            buf[i] = static_cast<char>(x & 0xff);
+        _sink.append(buf, bytes);
     }
 
-    return v;
-}
+    void write_head(unsigned char major, std::uint64_t arg)
+    {
+        if (arg < 24)
+        {
+            _sink.put(static_cast<char>(major | arg));
+        }
+        else if (arg <= 0xff)
+        {
+            _sink.put(static_cast<char>(major | 24));
+            _sink.put(static_cast<char>(arg));
+        }
+        else if (arg <= 0xffff)
+        {
+            _sink.put(static_cast<char>(major | 25));
+            write_be(arg, 2);
+        }
+        else if (arg <= 0xffffffff)
+        {
+            _sink.put(static_cast<char>(major | 26));
+            write_be(arg, 4);
+        }
+        else
+        {
+            _sink.put(static_cast<char>(major | 27));
+            write_be(arg, 8);
+        }
+    }
 
-template<typename T>
-T get(value const &source);
+    void write_text(const char *data, std::size_t size)
+    {
+        write_head(cbor_text, size);
+        _sink.append(data, size);
+    }
 
-template<typename T>
-struct info
-{
-    static bool is(value const &source)
+    void write_text(string const &s)
     {
-        return std::is_convertible<value, T>();
+        write_text(s.data(), s.size());
     }
 
-    static T get(value const &source)
+    void write_double(double d)
     {
-        assert(is(source));
-        return T(source);
+        float f = static_cast<float>(d);
+        if (f == d || d != d)
+        {
+            std::uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            _sink.put(static_cast<char>(cbor_simple | 26));
+            write_be(bits, 4);
+        }
+        else
+        {
+            std::uint64_t bits;
+            std::memcpy(&bits, &d, sizeof(bits));
+            _sink.put(static_cast<char>(cbor_simple | 27));
+            write_be(bits, 8);
+        }
+    }
+
+public:
+    explicit cbor_writer(Sink &sink)
+        : _sink(sink)
+    {
+    }
+
+    void write(value const &v)
+    {
+        switch (v._type)
+        {
+        case JSON_ARRAY:
+            write_head(cbor_array, v._array->value.size());
+            for (auto const &i : v._array->value)
+                write(i);
+            break;
+        case JSON_BOOL:
+            _sink.put(static_cast<char>(cbor_simple | (v._bool ? 21 : 20)));
+            break;
+        case JSON_NULL:
+            _sink.put(static_cast<char>(cbor_simple | 22));
+            break;
+        case JSON_NUMBER:
+            if (v._aux == JSON_INT64)
+            {
+                if (v._int < 0)
+                    write_head(cbor_negative, static_cast<std::uint64_t>(-1 - v._int));
+                else
+                    write_head(cbor_uint, static_cast<std::uint64_t>(v._int));
+            }
+            else if (v._aux == JSON_UINT64)
+            {
+                write_head(cbor_uint, v._uint);
+            }
+            else
+            {
+                write_double(v._number);
+            }
+            break;
+        case JSON_OBJECT:
+            write_head(cbor_map, v._object->value.size());
+            for (auto const &i : v._object->value)
+            {
+                write_text(i.first);
+                write(i.second);
+            }
+            break;
+        case JSON_STRING:
+            if (v._aux & value::escaped_bit)
+                write_text(v.get_string());
+            else if (v._aux)
+                write_text(v.view(), v._aux >> value::aux_shift);
+            else
+                write_text(v._string->value);
+            break;
+        }
     }
 };
 
-#define SPECIALIZE_INFO(TYPE, JSON_NAME) \
-    template<> \
-    struct info<TYPE> \
-    { \
-        static bool is(value const &source) \
-        { \
-            return source.is_##JSON_NAME();\
-        } \
-        \
-        static TYPE get(value const &source) \
-        { \
-            assert(is(source)); \
-            return static_cast<TYPE>(source.get_##JSON_NAME()); \
-        } \
+/**
+ * Reads one CBOR item as parse events for a handler, keeping the open
+ * arrays and maps on an explicit stack as the text tokenizer does.
+ * Strings must be text, and map keys text strings. Tags are skipped,
+ * undefined reads as null and half-precision floats are widened.
+ **/
+template <typename Handler>
+class cbor_reader
+{
+private:
+    struct frame
+    {
+        std::uint64_t left; // items still to read, unless indefinite
+        bool indefinite;
+        bool map;
     };
 
+    const char *_p;
+    const char *_end;
+    Handler &_handler;
+    std::vector<frame> _stack;
+    string _scratch;
 
-SPECIALIZE_INFO(string, string);
-SPECIALIZE_INFO(bool, bool);
-SPECIALIZE_INFO(float, number);
-SPECIALIZE_INFO(double, number);
-SPECIALIZE_INFO(int8_t, number);
-SPECIALIZE_INFO(int16_t, number);
-SPECIALIZE_INFO(int32_t, number);
-SPECIALIZE_INFO(int64_t, number);
-SPECIALIZE_INFO(uint8_t, number);
-SPECIALIZE_INFO(uint16_t, number);
-SPECIALIZE_INFO(uint32_t, number);
-SPECIALIZE_INFO(uint64_t, number);
+    unsigned char byte()
+    {
+        if (_p == _end)
+            throw exception("cbor: truncated input");
+        return static_cast<unsigned char>(*_p++);
+    }
 
-template<typename ArrayType>
-struct array_info
-{
-    using value_type = typename ArrayType::value_type;
+    std::uint64_t read_be(unsigned bytes)
+    {
+        if (static_cast<std::size_t>(_end - _p) < bytes)
+            throw exception("cbor: truncated input");
+        std::uint64_t x = 0;
+        for (unsigned i = 0; i < bytes; ++i)
+            x = x << 8 | static_cast<unsigned char>(_p[i]);
+        _p += bytes;
+        return x;
+    }
 
-    static bool is(value const &source)
+    // The argument encoded by the low five bits of an initial byte
+    std::uint64_t read_arg(unsigned char initial)
     {
-        if (!source.is_array())
+        unsigned info = initial & 0x1f;
+        if (info < 24)
+            return info;
+        if (info < 28)
+            return read_be(1u << (info - 24));
+        throw exception("cbor: bad argument");
+    }
+
+    // The characters of a text string whose initial byte has been read
+    string_ref read_text(unsigned char initial)
+    {
+        if ((initial & 0x1f) != 31)
         {
-            return false;
+            auto size = read_arg(initial);
+            if (static_cast<std::uint64_t>(_end - _p) < size)
+                throw exception("cbor: truncated input");
+            string_ref rv(_p, static_cast<std::size_t>(size));
+            _p += size;
+            return rv;
         }
-        auto const &array = source.get_array();
-        return std::find_if_not(array.begin(), array.end(), &info<value_type>::is) == array.end();
+        // An indefinite-length string is a run of definite chunks
+        _scratch.clear();
+        for (unsigned char c; (c = byte()) != 0xff;)
+        {
+            if ((c & 0xe0) != cbor_text || (c & 0x1f) == 31)
+                throw exception("cbor: bad string chunk");
+            auto chunk = read_text(c);
+            _scratch.append(chunk.data(), chunk.size());
+        }
+        return _scratch;
     }
-    
-    static ArrayType get(value const &source)
+
+    static double half_to_double(unsigned half)
     {
-        assert(is(source));
-        auto const &array = source.get_array();
-        ArrayType rv;
-        rv.reserve(array.size());
-        std::transform(array.begin(), array.end(), std::back_inserter(rv), &json::get<value_type>);
-        return rv;
+        int exponent = (half >> 10) & 0x1f;
+        double mantissa = half & 0x3ff, magnitude;
+        if (exponent == 0)
+            magnitude = std::ldexp(mantissa, -24);
+        else if (exponent == 31)
+            magnitude = mantissa ? std::numeric_limits<double>::quiet_NaN() : std::numeric_limits<double>::infinity();
+        else
+            magnitude = std::ldexp(mantissa + 1024, exponent - 25);
+        return half & 0x8000 ? -magnitude : magnitude;
     }
-};
-
-template<typename T, typename Allocator>
-struct info<std::vector<T, Allocator>> : array_info<std::vector<T, Allocator>>
-{};
 
-template<typename MapType>
-struct map_info
-{
-    using key_type = typename MapType::key_type;
-    using mapped_type = typename MapType::mapped_type;
+    void open(unsigned char initial, bool map)
+    {
+        if (_stack.size() >= max_depth().load(std::memory_order_relaxed))
+            throw exception("maximum depth exceeded");
+        if (map)
+            _handler.on_start_object();
+        else
+            _handler.on_start_array();
+        bool indefinite = (initial & 0x1f) == 31;
+        _stack.push_back(frame{ indefinite ? 0 : read_arg(initial), indefinite, map });
+        // Each member takes at least a byte, so a count beyond the input
+        // is an error to find later rather than memory to reserve now
+        if (_stack.back().left)
+            _handler.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(_stack.back().left, _end - _p)));
+    }
 
-    static bool is(value const &source)
+    // Read one item, or open a container and return without its items
+    void read_item()
     {
-        if (!source.is_object())
+        unsigned char initial;
+        while (((initial = byte()) & 0xe0) == cbor_tag)
+            read_arg(initial);
+        switch (initial & 0xe0)
         {
-            return false;
+        case cbor_uint:
+            _handler.on_number(value(static_cast<unsigned long long>(read_arg(initial))));
+            return;
+        case cbor_negative:
+        {
+            auto n = read_arg(initial);
+            if (n <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()))
+                _handler.on_number(value(static_cast<long long>(-1 - static_cast<std::int64_t>(n))));
+            else
+                _handler.on_number(value(-1.0 - static_cast<double>(n)));
+            return;
         }
-        if (!std::is_convertible<key_type, string>::value)
+        case cbor_text:
+            _handler.on_string(read_text(initial));
+            return;
+        case cbor_array:
+            return open(initial, false);
+        case cbor_map:
+            return open(initial, true);
+        case cbor_simple:
+            break;
+        default:
+            throw exception("cbor: byte strings are not supported");
+        }
+        switch (initial & 0x1f)
         {
-            return false;
+        case 20:
+        case 21:
+            return _handler.on_bool(initial & 1);
+        case 22:
+        case 23:
+            return _handler.on_null();
+        case 25:
+            return _handler.on_number(value(half_to_double(static_cast<unsigned>(read_be(2)))));
+        case 26:
+        {
+            auto bits = static_cast<std::uint32_t>(read_be(4));
+            float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            return _handler.on_number(value(static_cast<double>(f)));
         }
-        auto const &object = source.get_object();
-        return std::find_if_not(object.begin(), object.end(), [](std::pair<string, value> const &pair)
+        case 27:
         {
-            return info<mapped_type>::is(pair.second);
-        }) == object.end();
+            auto bits = read_be(8);
+            double d;
+            std::memcpy(&d, &bits, sizeof(d));
+            return _handler.on_number(value(d));
+        }
+        default:
+            throw exception("cbor: unsupported simple value");
+        }
     }
-    
-    static MapType get(value const &source)
+
+public:
+    cbor_reader(const char *data, const char *end, Handler &handler)
+        : _p(data)
+        , _end(end)
+        , _handler(handler)
     {
-        assert(is(source));
-        auto const &object = source.get_object();
-        MapType map;
-        map.reserve(object.size());
-        for (auto const &pair : object)
+    }
+
+    /**
+     * Read one complete item
+     * @return the end of the item
+     **/
+    const char *read()
+    {
+        read_item();
+        while (!_stack.empty())
         {
-            map.emplace(pair.first, json::get<mapped_type>(pair.second));
+            auto &top = _stack.back();
+            bool done = top.indefinite ? _p != _end && static_cast<unsigned char>(*_p) == 0xff : top.left == 0;
+            if (done)
+            {
+                if (top.indefinite)
+                    ++_p;
+                bool map = top.map;
+                _stack.pop_back();
+                if (map)
+                    _handler.on_end_object();
+                else
+                    _handler.on_end_array();
+                continue;
+            }
+            if (!top.indefinite)
+                --top.left;
+            if (top.map)
+            {
+                auto initial = byte();
+                if ((initial & 0xe0) != cbor_text)
+                    throw exception("cbor: map keys must be strings");
+                _handler.on_key(read_text(initial));
+            }
+            read_item();
         }
-        return map;
+        return _p;
     }
 };
 
+} // namespace detail
+/**
+ * @endcond detail
+ **/
 
-template<typename Key, typename T, typename Compare, typename Allocator>
-struct info<std::map<Key, T, Compare, Allocator>> : map_info<std::map<Key, T, Compare, Allocator>>
-{};
-
-template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
-struct info<std::unordered_map<Key, T, Hash, KeyEqual, Allocator>> : map_info<std::unordered_map<Key, T, Hash, KeyEqual, Allocator>>
-{};
-
-#undef SPECIALIZE_INFO
-
-template<typename T>
-bool is(value const &source)
+/**
+ * @brief serialize a value as CBOR (RFC 8949), appending to out
+ *
+ * Numbers are written as raw integers or floats and strings with their
+ * length up front, so reading them back needs no number parsing or
+ * unescaping.
+ **/
+inline void to_cbor(value const &v, string &out)
 {
-    return info<T>::is(source);
+    detail::string_sink sink(out);
+    detail::cbor_writer<detail::string_sink>(sink).write(v);
 }
 
-template<typename T>
-bool get(value const &source, T &value_out)
+/**
+ * @return a value serialized as CBOR
+ * @see to_cbor(value const &, string &)
+ **/
+inline string to_cbor(value const &v)
 {
-    if (!info<T>::is(source))
-    {
-        return false;
-    }
-    value_out = info<T>::get(source);
-    return true;
+    string rv;
+    to_cbor(v, rv);
+    return rv;
 }
 
-template<typename T>
-T get(value const &source)
+/**
+ * @brief read a value from a single CBOR item
+ *
+ * Integers keep their exact value and floats of any precision become
+ * doubles. Byte strings, non-string map keys and simple values other
+ * than false, true, null and undefined (read as null) are rejected.
+ *
+ * @param data the CBOR bytes
+ * @param size the length of the input in bytes
+ * @return the decoded @ref value
+ * @throw @ref exception if the input is not a single well-formed item
+ **/
+inline value from_cbor(const char *data, std::size_t size)
 {
-    return info<T>::get(source);
+    detail::dom_builder<false> builder;
+    auto end = detail::cbor_reader<detail::dom_builder<false>>(data, data + size, builder).read();
+    if (end != data + size)
+        throw exception("cbor: garbage at end of input");
+    return std::move(builder.result());
 }
 
-template<typename T>
-bool get_member(value const &source, string const &key, T &value_out)
+/**
+ * @see from_cbor(const char *, std::size_t)
+ **/
+inline value from_cbor(string const &s)
 {
-    if (!source.is_object())
-    {
-        return false;
-    }
-
-    auto const &object = source.get_object();
-    auto it = object.find(key);
-    if (it == object.end())
-    {
-        return false;
-    }
-    
-    return get(it->second, value_out);
+    return from_cbor(s.data(), s.size());
 }
 
-
+} // namespace JSON_CONFIG_NAMESPACE
 } // namespace json
 
 #endif